@@ -0,0 +1,191 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_log.hpp>
+#include <stdsc/stdsc_plaindata.hpp>
+
+/*
+ * Compares serialization through BufferWriter/BufferReader with the
+ * std::ostream/std::istream interface over BufferStream, for single
+ * values and for the binary format of PlainData.
+ *   usage: stdsc_bench_cursor [-n count] [-r repeat]
+ */
+
+namespace
+{
+
+volatile uint64_t sink; ///< keeps the reads from being optimized out
+
+double now_sec(void)
+{
+    return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/* Returns the shortest time of `repeat` runs of `func` in seconds. */
+template <class F>
+double best_of(const int repeat, const F& func)
+{
+    double best = 0;
+    for (int i = 0; i < repeat; ++i)
+    {
+        const double start = now_sec();
+        func();
+        const double elapsed = now_sec() - start;
+        if (i == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+void report(const char* name, const double stream_sec,
+            const double cursor_sec, const std::size_t count)
+{
+    printf("%-20s stream %8.2f ns/elem  cursor %8.2f ns/elem  (x%.1f)\n",
+           name, stream_sec * 1e9 / count, cursor_sec * 1e9 / count,
+           stream_sec / cursor_sec);
+}
+
+void bench_values(const std::size_t count, const int repeat)
+{
+    const std::size_t size = count * sizeof(uint32_t);
+    uint64_t sum = 0;
+
+    stdsc::BufferStream sbuf(size);
+    const double stream_put = best_of(repeat, [&] {
+        sbuf.pubseekpos(0, std::ios_base::out);
+        std::ostream os(&sbuf);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const uint32_t v = static_cast<uint32_t>(i);
+            os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+    });
+    const double stream_get = best_of(repeat, [&] {
+        sbuf.pubseekpos(0, std::ios_base::in);
+        std::istream is(&sbuf);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint32_t v;
+            is.read(reinterpret_cast<char*>(&v), sizeof(v));
+            sum += v;
+        }
+    });
+
+    stdsc::Buffer buffer(size);
+    const double cursor_put = best_of(repeat, [&] {
+        stdsc::BufferWriter writer(buffer);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            writer.put(static_cast<uint32_t>(i));
+        }
+        writer.finish();
+    });
+    const double cursor_get = best_of(repeat, [&] {
+        stdsc::BufferReader reader(buffer);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            sum += reader.get<uint32_t>();
+        }
+    });
+
+    report("put uint32", stream_put, cursor_put, count);
+    report("get uint32", stream_get, cursor_get, count);
+    sink = sum;
+}
+
+void bench_plaindata(const std::size_t count, const int repeat)
+{
+    stdsc::PlainData<double> src(stdsc::kPlainDataFormatBinary);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        src.push(static_cast<double>(i) * 0.5);
+    }
+    const std::size_t size = src.stream_size();
+
+    stdsc::BufferStream sbuf(size);
+    const double stream_save = best_of(repeat, [&] {
+        sbuf.pubseekpos(0, std::ios_base::out);
+        std::ostream os(&sbuf);
+        src.save_to_stream(os);
+    });
+    stdsc::PlainData<double> dst(stdsc::kPlainDataFormatBinary);
+    const double stream_load = best_of(repeat, [&] {
+        sbuf.pubseekpos(0, std::ios_base::in);
+        std::istream is(&sbuf);
+        dst.load_from_stream(is);
+    });
+
+    stdsc::Buffer buffer(size);
+    const double cursor_save = best_of(repeat, [&] {
+        stdsc::BufferWriter writer(buffer);
+        src.save_to_buffer(writer);
+        writer.finish();
+    });
+    const double cursor_load = best_of(repeat, [&] {
+        stdsc::BufferReader reader(buffer);
+        dst.load_from_buffer(reader);
+    });
+
+    report("PlainData save", stream_save, cursor_save, count);
+    report("PlainData load", stream_load, cursor_load, count);
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+    std::size_t count = 1 << 22;
+    int repeat = 5;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                count = strtoul(optarg, nullptr, 10);
+                break;
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n count] [-r repeat]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    STDSC_INIT_LOG();
+    STDSC_SET_LOG_LEVEL(stdsc::kLogLevelWarn);
+
+    printf("%zu elements, best of %d runs\n", count, repeat);
+    bench_values(count, repeat);
+    bench_plaindata(count, repeat);
+    return 0;
+}
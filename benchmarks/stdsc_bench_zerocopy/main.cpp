@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <thread>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_log.hpp>
+#include <stdsc/stdsc_socket.hpp>
+
+/*
+ * Measures the CPU time of the sending thread per GB sent over loopback,
+ * with the copying send path and with MSG_ZEROCOPY.
+ *   usage: stdsc_bench_zerocopy [-s size_mb] [-n count] [-p port]
+ */
+
+namespace
+{
+
+double thread_cpu_sec(void)
+{
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double run(const char* port, const std::size_t size, const int count,
+           const bool zerocopy)
+{
+    stdsc::Socket listen_sock = stdsc::Socket::make_listen_socket(port, SO_REUSEADDR);
+    std::thread receiver([&] {
+        stdsc::Socket sock = stdsc::Socket::accept_connection(listen_sock);
+        stdsc::Buffer buffer(size);
+        for (int i = 0; i < count; ++i)
+        {
+            sock.recv_buffer(buffer);
+        }
+        sock.close();
+    });
+
+    stdsc::Socket sock = stdsc::Socket::establish_connection("localhost", port);
+    if (zerocopy && !sock.enable_zerocopy(size))
+    {
+        fprintf(stderr, "zerocopy is not supported\n");
+    }
+
+    stdsc::Buffer buffer(size);
+    memset(buffer.data(), 0x5a, size);
+
+    const double start = thread_cpu_sec();
+    for (int i = 0; i < count; ++i)
+    {
+        sock.send_buffer(buffer);
+    }
+    sock.flush_zerocopy();
+    const double cpu = thread_cpu_sec() - start;
+
+    receiver.join();
+    sock.close();
+    listen_sock.close();
+
+    const double gb = static_cast<double>(size) * count / (1 << 30);
+    return cpu / gb;
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+    std::size_t size_mb = 64;
+    int count = 16;
+    const char* port = "23470";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:p:")) != -1)
+    {
+        switch (opt)
+        {
+            case 's':
+                size_mb = strtoul(optarg, nullptr, 10);
+                break;
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 'p':
+                port = optarg;
+                break;
+            default:
+                fprintf(stderr,
+                        "usage: %s [-s size_mb] [-n count] [-p port]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    STDSC_INIT_LOG();
+    STDSC_SET_LOG_LEVEL(stdsc::kLogLevelWarn);
+
+    const std::size_t size = size_mb << 20;
+    printf("%d sends of %zu MB\n", count, size_mb);
+    printf("copy     : %.3f CPU sec/GB\n", run(port, size, count, false));
+    printf("zerocopy : %.3f CPU sec/GB\n", run(port, size, count, true));
+    return 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <stdsc/stdsc_async_writer.hpp>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_define.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+namespace stdsc
+{
+
+namespace
+{
+
+std::string error_message(const std::string& what, const std::string& filepath)
+{
+    std::ostringstream oss;
+    oss << what << " (" << filepath << ": " << std::strerror(errno) << ")";
+    return oss.str();
+}
+
+/**
+ * Writes all bytes, retrying on short writes and EINTR.
+ */
+bool write_all(int fd, const uint8_t* p, std::size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief Closes the file descriptor on scope exit.
+ */
+struct FileCloser
+{
+    explicit FileCloser(int fd) : fd_(fd)
+    {
+    }
+    ~FileCloser(void)
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+    }
+    int release(void)
+    {
+        int fd = fd_;
+        fd_ = -1;
+        return fd;
+    }
+    int fd_;
+};
+
+} /* namespace */
+
+struct AsyncWriter::Impl
+{
+    struct Request
+    {
+        std::string filepath;
+        Buffer buffer;
+        std::promise<void> promise;
+    };
+
+    Impl(void)
+      : direct_io_(false), stop_(false), busy_(false), chunk_(nullptr)
+    {
+        th_ = std::thread(&Impl::run, this);
+    }
+
+    ~Impl(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        th_.join();
+        std::free(chunk_);
+    }
+
+    std::future<void> write(const std::string& filepath, const Buffer& buffer)
+    {
+        std::unique_ptr<Request> req(
+          new Request{filepath, buffer, std::promise<void>()});
+        auto future = req->promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            queue_.push_back(std::move(req));
+        }
+        cond_.notify_all();
+        return future;
+    }
+
+    void flush(void)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        done_.wait(lock, [this] { return queue_.empty() && !busy_; });
+    }
+
+    void run(void)
+    {
+        for (;;)
+        {
+            std::unique_ptr<Request> req;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (queue_.empty())
+                {
+                    return;
+                }
+                req = std::move(queue_.front());
+                queue_.pop_front();
+                busy_ = true;
+            }
+
+            try
+            {
+                write_file(req->filepath, req->buffer);
+                req->promise.set_value();
+            }
+            catch (...)
+            {
+                req->promise.set_exception(std::current_exception());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                busy_ = false;
+            }
+            done_.notify_all();
+        }
+    }
+
+    void write_file(const std::string& filepath, const Buffer& buffer)
+    {
+        const auto* p = static_cast<const uint8_t*>(buffer.data());
+        const auto size = buffer.size();
+
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+        int fd = -1;
+        bool direct = false;
+#ifdef O_DIRECT
+        if (direct_io_ && size >= STDSC_DIRECT_IO_ALIGNMENT)
+        {
+            fd = ::open(filepath.c_str(), flags | O_DIRECT, 0644);
+            direct = (fd >= 0);
+        }
+#endif
+        if (fd < 0)
+        {
+            fd = ::open(filepath.c_str(), flags, 0644);
+        }
+        STDSC_THROW_FILE_IF_CHECK(fd >= 0,
+                                  error_message("Failed to open file.", filepath));
+        FileCloser closer(fd);
+
+        if (direct)
+        {
+            write_direct(fd, filepath, p, size);
+        }
+        else
+        {
+            for (std::size_t off = 0; off < size; off += STDSC_ASYNC_WRITE_CHUNK_SIZE)
+            {
+                auto n = std::min<std::size_t>(STDSC_ASYNC_WRITE_CHUNK_SIZE,
+                                               size - off);
+                STDSC_THROW_FILE_IF_CHECK(
+                  write_all(fd, p + off, n),
+                  error_message("Failed to write file.", filepath));
+            }
+        }
+
+        STDSC_THROW_FILE_IF_CHECK(
+          ::close(closer.release()) == 0,
+          error_message("Failed to close file.", filepath));
+    }
+
+    /**
+     * Writes through an aligned bounce buffer. The last chunk is padded to
+     * the alignment, and the file is truncated to the size afterwards.
+     */
+    void write_direct(int fd, const std::string& filepath, const uint8_t* p,
+                      const std::size_t size)
+    {
+        if (!chunk_)
+        {
+            STDSC_THROW_FILE_IF_CHECK(
+              posix_memalign(&chunk_, STDSC_DIRECT_IO_ALIGNMENT,
+                             STDSC_ASYNC_WRITE_CHUNK_SIZE) == 0,
+              "Failed to allocate buffer for direct I/O.");
+        }
+        auto* chunk = static_cast<uint8_t*>(chunk_);
+        for (std::size_t off = 0; off < size; off += STDSC_ASYNC_WRITE_CHUNK_SIZE)
+        {
+            auto n = std::min<std::size_t>(STDSC_ASYNC_WRITE_CHUNK_SIZE,
+                                           size - off);
+            std::memcpy(chunk, p + off, n);
+            auto padded = (n + STDSC_DIRECT_IO_ALIGNMENT - 1) /
+                          STDSC_DIRECT_IO_ALIGNMENT * STDSC_DIRECT_IO_ALIGNMENT;
+            std::memset(chunk + n, 0, padded - n);
+            STDSC_THROW_FILE_IF_CHECK(
+              write_all(fd, chunk, padded),
+              error_message("Failed to write file.", filepath));
+        }
+        STDSC_THROW_FILE_IF_CHECK(
+          ::ftruncate(fd, static_cast<off_t>(size)) == 0,
+          error_message("Failed to truncate file.", filepath));
+    }
+
+    std::atomic<bool> direct_io_;
+    bool stop_;
+    bool busy_;
+    void* chunk_;
+    std::deque<std::unique_ptr<Request>> queue_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::condition_variable done_;
+    std::thread th_;
+};
+
+AsyncWriter::AsyncWriter(void) : pimpl_(new Impl())
+{
+}
+
+AsyncWriter::~AsyncWriter(void)
+{
+}
+
+AsyncWriter& AsyncWriter::instance(void)
+{
+    static AsyncWriter writer;
+    return writer;
+}
+
+void AsyncWriter::enable_direct_io(void)
+{
+    pimpl_->direct_io_ = true;
+}
+
+void AsyncWriter::disable_direct_io(void)
+{
+    pimpl_->direct_io_ = false;
+}
+
+bool AsyncWriter::is_direct_io_enabled(void) const
+{
+    return pimpl_->direct_io_;
+}
+
+std::future<void> AsyncWriter::write(const std::string& filepath,
+                                     const Buffer& buffer)
+{
+    return pimpl_->write(filepath, buffer);
+}
+
+void AsyncWriter::flush(void)
+{
+    pimpl_->flush();
+}
+
+} /* namespace stdsc */
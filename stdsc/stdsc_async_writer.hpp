@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_ASYNC_WRITER_HPP
+#define STDSC_ASYNC_WRITER_HPP
+
+#include <future>
+#include <memory>
+#include <string>
+
+namespace stdsc
+{
+
+class Buffer;
+
+/**
+ * @brief Writes buffers to files on a background thread.
+ * The requests are written in order of submission. The file is written in
+ * aligned chunks of STDSC_ASYNC_WRITE_CHUNK_SIZE, with O_DIRECT if it is
+ * enabled and supported by the file system.
+ */
+class AsyncWriter
+{
+public:
+    AsyncWriter(void);
+    ~AsyncWriter(void);
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    /**
+     * Returns the writer shared in the process.
+     */
+    static AsyncWriter& instance(void);
+
+    void enable_direct_io(void);
+    void disable_direct_io(void);
+    bool is_direct_io_enabled(void) const;
+
+    /**
+     * Queues the buffer to be written to the file. The buffer is held until
+     * the write completes. The future is set when the file is closed, or
+     * holds FileException on failure. The data is not copied (see Buffer),
+     * so it must not be modified until the future is set.
+     */
+    std::future<void> write(const std::string& filepath, const Buffer& buffer);
+
+    /**
+     * Waits until all queued writes complete.
+     */
+    void flush(void);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_ASYNC_WRITER_HPP */
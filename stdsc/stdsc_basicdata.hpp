@@ -22,9 +22,14 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <future>
 #include <stdsc/stdsc_exception.hpp>
 #include <stdsc/stdsc_log.hpp>
 #include <stdsc/stdsc_utility.hpp>
+#include <stdsc/stdsc_streambuf.hpp>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_async_writer.hpp>
 
 namespace stdsc
 {
@@ -65,6 +70,20 @@ struct BasicData
         ofs.close();
     }
     
+    /**
+     * Saves the data to the file on the background thread of AsyncWriter.
+     * The data is serialized by save_to_buffer before returning, so it may
+     * be modified while the file is written.
+     */
+    virtual std::future<void> save_to_file_async(const std::string& filepath) const
+    {
+        Buffer buffer(0);
+        BufferWriter writer(buffer);
+        save_to_buffer(writer);
+        writer.finish();
+        return AsyncWriter::instance().write(filepath, buffer);
+    }
+
     virtual void load_from_file(const std::string& filepath)
     {
         if (!stdsc::utility::file_exist(filepath)) {
@@ -101,11 +120,46 @@ struct BasicData
         return vec_;
     }        
 
+    /**
+     * Returns the size of the data saved by save_to_stream.
+     * The subclasses should override this if the size can be calculated
+     * without serialization. By default, the output of save_to_stream is
+     * counted and discarded, so sizing a stream with this and then saving
+     * serializes the data twice. Senders that need the size of such data
+     * should save it to a buffer once and send the buffer instead.
+     */
     virtual size_t stream_size(void) const
+    {
+        CountingStreamBuf counter;
+        std::ostream os(&counter);
+        save_to_stream(os);
+        return counter.count();
+    }
+
+    /**
+     * Saves the data at the writer position. The subclasses should override
+     * this if they can write Buffer directly. By default, the output of
+     * save_to_stream is copied into the buffer.
+     */
+    virtual void save_to_buffer(BufferWriter& writer) const
     {
         std::ostringstream oss;
         save_to_stream(oss);
-        return oss.str().size();
+        auto str = oss.str();
+        writer.write(str.data(), str.size());
+    }
+
+    /**
+     * Loads the data at the reader position, and skips the bytes consumed.
+     * By default, the rest of the buffer is read by load_from_stream.
+     */
+    virtual void load_from_buffer(BufferReader& reader)
+    {
+        auto start = reader.position();
+        BufferStream bs(reader.get_slice(reader.remaining()));
+        std::istream is(&bs);
+        load_from_stream(is);
+        reader.seek(start + bs.size() - static_cast<size_t>(bs.in_avail()));
     }
 
 protected:
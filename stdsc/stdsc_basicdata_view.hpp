@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_BASICDATA_VIEW_HPP
+#define STDSC_BASICDATA_VIEW_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_binary_codec.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+namespace stdsc
+{
+
+/**
+ * @brief Provides read-only access to the data in binary format.
+ * The elements are accessed in place in the buffer without copying.
+ * The view holds a copy of the buffer, which shares and keeps alive its
+ * storage.
+ */
+template <class T>
+class BasicDataView
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "BasicDataView requires trivially copyable type.");
+
+public:
+    explicit BasicDataView(const Buffer& buffer) : buffer_(buffer), count_(0)
+    {
+        STDSC_THROW_FAILURE_IF_CHECK(sizeof(BinaryHeader) <= buffer_.size(),
+                                     "Buffer is too small.");
+        BinaryHeader header;
+        std::memcpy(&header, buffer_.data(), sizeof(header));
+        STDSC_THROW_FAILURE_IF_CHECK(header.magic == STDSC_BINARY_MAGIC,
+                                     "Invalid binary format.");
+        STDSC_THROW_FAILURE_IF_CHECK(header.version == STDSC_BINARY_VERSION,
+                                     "Unsupported binary format version.");
+        STDSC_THROW_FAILURE_IF_CHECK(header.element_size == sizeof(T),
+                                     "Mismatched element size.");
+        STDSC_THROW_FAILURE_IF_CHECK(
+          header.count <= (buffer_.size() - sizeof(header)) / sizeof(T),
+          "Buffer is shorter than the element count.");
+        STDSC_THROW_FAILURE_IF_CHECK(
+          reinterpret_cast<uintptr_t>(data()) % alignof(T) == 0,
+          "Elements are not aligned.");
+        count_ = static_cast<std::size_t>(header.count);
+    }
+
+    virtual ~BasicDataView(void) = default;
+
+    std::size_t size(void) const
+    {
+        return count_;
+    }
+
+    bool empty(void) const
+    {
+        return count_ == 0;
+    }
+
+    const T* data(void) const
+    {
+        return reinterpret_cast<const T*>(
+          static_cast<const uint8_t*>(buffer_.data()) + sizeof(BinaryHeader));
+    }
+
+    const T& operator[](std::size_t index) const
+    {
+        return data()[index];
+    }
+
+    const T& at(std::size_t index) const
+    {
+        STDSC_THROW_INVPARAM_IF_CHECK(index < count_,
+                                      "Index is out of range.");
+        return data()[index];
+    }
+
+    const T* begin(void) const
+    {
+        return data();
+    }
+
+    const T* end(void) const
+    {
+        return data() + count_;
+    }
+
+    const Buffer& buffer(void) const
+    {
+        return buffer_;
+    }
+
+private:
+    Buffer buffer_;
+    std::size_t count_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_BASICDATA_VIEW_HPP */
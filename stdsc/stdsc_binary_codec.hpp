@@ -0,0 +1,327 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_BINARY_CODEC_HPP
+#define STDSC_BINARY_CODEC_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+#include <stdsc/stdsc_define.hpp>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_streambuf.hpp>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+
+namespace stdsc
+{
+
+static constexpr uint32_t STDSC_BINARY_MAGIC = 0x4E424453; /* "SDBN" */
+static constexpr uint16_t STDSC_BINARY_VERSION = 1;
+
+/**
+ * @brief Header of the binary format of data.
+ * The elements follow the header in host byte order.
+ */
+struct BinaryHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t element_size; ///< 0 if the elements have variable length
+    uint64_t count;
+};
+
+/**
+ * Reads `len` bytes into `str`. The string grows chunk by chunk as the
+ * bytes arrive, so that a corrupt length fails at the end of the stream
+ * instead of being allocated at once.
+ */
+inline void read_binary_string(std::istream& is, const uint64_t len,
+                               std::string& str)
+{
+    str.clear();
+    while (str.size() < len)
+    {
+        const auto pos = str.size();
+        const auto n = static_cast<std::size_t>(
+          std::min<uint64_t>(len - pos, STDSC_STREAM_CHUNK_SIZE));
+        str.resize(pos + n);
+        is.read(&str[pos], static_cast<std::streamsize>(n));
+        STDSC_THROW_FAILURE_IF_CHECK(
+          is.gcount() == static_cast<std::streamsize>(n),
+          "Failed to read element.");
+    }
+}
+
+/**
+ * @brief Serializes an element which is not trivially copyable.
+ * The element is written as length-prefixed text by operator<<.
+ * Specialize this for the types which need other representation.
+ */
+template <class T>
+struct BinaryElementCodec
+{
+    static void save(std::ostream& os, const T& v)
+    {
+        std::ostringstream oss;
+        oss.precision(std::numeric_limits<long double>::max_digits10);
+        oss << v;
+        auto str = oss.str();
+        uint64_t len = str.size();
+        os.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        os.write(str.data(), str.size());
+    }
+
+    static void load(std::istream& is, T& v)
+    {
+        uint64_t len = 0;
+        is.read(reinterpret_cast<char*>(&len), sizeof(len));
+        STDSC_THROW_FAILURE_IF_CHECK(is.good(), "Failed to read element.");
+        std::string str;
+        read_binary_string(is, len, str);
+        std::istringstream iss(str);
+        iss >> v;
+        STDSC_THROW_FAILURE_IF_CHECK(!iss.fail(), "Failed to parse element.");
+    }
+};
+
+template <>
+struct BinaryElementCodec<std::string>
+{
+    static void save(std::ostream& os, const std::string& v)
+    {
+        uint64_t len = v.size();
+        os.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        os.write(v.data(), v.size());
+    }
+
+    static void load(std::istream& is, std::string& v)
+    {
+        uint64_t len = 0;
+        is.read(reinterpret_cast<char*>(&len), sizeof(len));
+        STDSC_THROW_FAILURE_IF_CHECK(is.good(), "Failed to read element.");
+        read_binary_string(is, len, v);
+    }
+};
+
+/**
+ * @brief Provides the binary format of a vector of elements.
+ * The trivially copyable elements are written and read in bulk, the others
+ * one by one with BinaryElementCodec.
+ */
+template <class T>
+struct BinaryCodec
+{
+    using is_bulk = std::integral_constant<bool,
+                                           std::is_trivially_copyable<T>::value>;
+
+    static constexpr uint16_t element_size(void)
+    {
+        return is_bulk::value ? static_cast<uint16_t>(sizeof(T)) : 0;
+    }
+
+    static BinaryHeader make_header(const uint64_t count)
+    {
+        BinaryHeader header;
+        header.magic = STDSC_BINARY_MAGIC;
+        header.version = STDSC_BINARY_VERSION;
+        header.element_size = element_size();
+        header.count = count;
+        return header;
+    }
+
+    /**
+     * Returns true if the stream starts with the binary header.
+     */
+    static bool is_binary(std::istream& is)
+    {
+        const auto magic = STDSC_BINARY_MAGIC;
+        auto c = is.peek();
+        return c != std::char_traits<char>::eof() &&
+               static_cast<char>(c) == *reinterpret_cast<const char*>(&magic);
+    }
+
+    /**
+     * Returns the size of the data saved by save().
+     * It is calculated without serialization if the elements are trivially
+     * copyable.
+     */
+    static std::size_t stream_size(const std::vector<T>& vec)
+    {
+        return stream_size(vec, is_bulk());
+    }
+
+    static void save(std::ostream& os, const std::vector<T>& vec)
+    {
+        auto header = make_header(vec.size());
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        save_elements(os, vec, is_bulk());
+    }
+
+    static void load(std::istream& is, std::vector<T>& vec)
+    {
+        BinaryHeader header;
+        is.read(reinterpret_cast<char*>(&header), sizeof(header));
+        STDSC_THROW_FAILURE_IF_CHECK(is.good(), "Failed to read header.");
+        check_header(header);
+        load_elements(is, header.count, vec, is_bulk());
+    }
+
+    /**
+     * Returns true if the reader is at the binary header.
+     */
+    static bool is_binary(const BufferReader& reader)
+    {
+        const auto magic = STDSC_BINARY_MAGIC;
+        return sizeof(magic) <= reader.remaining() &&
+               std::memcmp(reader.peek(sizeof(magic)), &magic,
+                           sizeof(magic)) == 0;
+    }
+
+    static void save(BufferWriter& writer, const std::vector<T>& vec)
+    {
+        save(writer, vec, is_bulk());
+    }
+
+    static void load(BufferReader& reader, std::vector<T>& vec)
+    {
+        load(reader, vec, is_bulk());
+    }
+
+private:
+    static void check_header(const BinaryHeader& header)
+    {
+        STDSC_THROW_FAILURE_IF_CHECK(header.magic == STDSC_BINARY_MAGIC,
+                                     "Invalid binary format.");
+        STDSC_THROW_FAILURE_IF_CHECK(header.version == STDSC_BINARY_VERSION,
+                                     "Unsupported binary format version.");
+        STDSC_THROW_FAILURE_IF_CHECK(header.element_size == element_size(),
+                                     "Mismatched element size.");
+    }
+
+    static void save(BufferWriter& writer, const std::vector<T>& vec,
+                     std::true_type)
+    {
+        writer.reserve(stream_size(vec));
+        writer.put(make_header(vec.size()));
+        writer.write(vec.data(), vec.size() * sizeof(T));
+    }
+
+    static void save(BufferWriter& writer, const std::vector<T>& vec,
+                     std::false_type)
+    {
+        std::ostringstream oss;
+        save(oss, vec);
+        auto str = oss.str();
+        writer.write(str.data(), str.size());
+    }
+
+    static void load(BufferReader& reader, std::vector<T>& vec, std::true_type)
+    {
+        auto header = reader.get<BinaryHeader>();
+        check_header(header);
+        STDSC_THROW_FAILURE_IF_CHECK(
+          header.count <= reader.remaining() / sizeof(T),
+          "Failed to read elements.");
+        vec.resize(static_cast<std::size_t>(header.count));
+        reader.read(vec.data(), vec.size() * sizeof(T));
+    }
+
+    static void load(BufferReader& reader, std::vector<T>& vec, std::false_type)
+    {
+        auto start = reader.position();
+        BufferStream bs(reader.get_slice(reader.remaining()));
+        std::istream is(&bs);
+        load(is, vec);
+        reader.seek(start + bs.size() - static_cast<std::size_t>(bs.in_avail()));
+    }
+
+    static std::size_t stream_size(const std::vector<T>& vec, std::true_type)
+    {
+        return sizeof(BinaryHeader) + vec.size() * sizeof(T);
+    }
+
+    static std::size_t stream_size(const std::vector<T>& vec, std::false_type)
+    {
+        CountingStreamBuf counter;
+        std::ostream os(&counter);
+        save(os, vec);
+        return counter.count();
+    }
+
+    static void save_elements(std::ostream& os, const std::vector<T>& vec,
+                              std::true_type)
+    {
+        os.write(reinterpret_cast<const char*>(vec.data()),
+                 vec.size() * sizeof(T));
+    }
+
+    static void save_elements(std::ostream& os, const std::vector<T>& vec,
+                              std::false_type)
+    {
+        for (const auto& v : vec)
+        {
+            BinaryElementCodec<T>::save(os, v);
+        }
+    }
+
+    /* The vector grows chunk by chunk as the elements arrive, so that a
+     * corrupt count fails at the end of the stream instead of being
+     * allocated at once. */
+    static void load_elements(std::istream& is, const uint64_t count,
+                              std::vector<T>& vec, std::true_type)
+    {
+        STDSC_THROW_FAILURE_IF_CHECK(
+          count <= std::numeric_limits<std::size_t>::max() / sizeof(T),
+          "Invalid element count.");
+        const uint64_t chunk =
+          std::max<uint64_t>(1, STDSC_STREAM_CHUNK_SIZE / sizeof(T));
+        vec.clear();
+        while (vec.size() < count)
+        {
+            const auto pos = vec.size();
+            const auto n =
+              static_cast<std::size_t>(std::min<uint64_t>(count - pos, chunk));
+            vec.resize(pos + n);
+            const auto bytes = static_cast<std::streamsize>(n * sizeof(T));
+            is.read(reinterpret_cast<char*>(vec.data() + pos), bytes);
+            STDSC_THROW_FAILURE_IF_CHECK(is.gcount() == bytes,
+                                         "Failed to read elements.");
+        }
+    }
+
+    static void load_elements(std::istream& is, const uint64_t count,
+                              std::vector<T>& vec, std::false_type)
+    {
+        vec.clear();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            T v;
+            BinaryElementCodec<T>::load(is, v);
+            vec.push_back(std::move(v));
+        }
+    }
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_BINARY_CODEC_HPP */
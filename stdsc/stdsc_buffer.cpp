@@ -15,8 +15,11 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <vector>
+#include <cstring>
 #include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_exception.hpp>
 
 namespace stdsc
 {
@@ -25,62 +28,188 @@ namespace stdsc
 
 struct Buffer::Impl
 {
-    Impl(void) : buffer_()
+    Impl(void) : buffer_(), slices_(0)
     {
     }
 
-    Impl(std::size_t size) : buffer_(size)
+    Impl(std::size_t size) : buffer_(size), slices_(0)
     {
     }
 
-    Impl(std::size_t size, uint8_t val) : buffer_(size, val)
+    Impl(std::size_t size, uint8_t val) : buffer_(size, val), slices_(0)
     {
     }
 
     std::vector<uint8_t> buffer_;
+    std::atomic<std::size_t> slices_; ///< number of slices alive
 };
 
-Buffer::Buffer(void) : pimpl_(new Impl())
+Buffer::Buffer(void) : pimpl_(), offset_(0), length_(0), is_slice_(false)
 {
 }
 
-Buffer::Buffer(std::size_t size) : pimpl_(new Impl(size))
+Buffer::Buffer(std::size_t size) : Buffer(size, 0)
 {
 }
 
-Buffer::Buffer(std::size_t size, uint8_t val) : pimpl_(new Impl(size, val))
+Buffer::Buffer(std::size_t size, uint8_t val)
+  : pimpl_(), offset_(0), length_(0), is_slice_(false)
 {
+    if (size <= STDSC_BUFFER_INLINE_SIZE)
+    {
+        std::memset(inline_, val, size);
+        length_ = size;
+    }
+    else
+    {
+        pimpl_ = std::make_shared<Impl>(size, val);
+    }
+}
+
+Buffer::Buffer(const Buffer& buffer)
+  : pimpl_(), offset_(0), length_(0), is_slice_(buffer.is_slice_)
+{
+    buffer.share();
+    pimpl_ = buffer.pimpl_;
+    offset_ = buffer.offset_;
+    length_ = buffer.length_;
+    if (is_slice_)
+    {
+        ++pimpl_->slices_;
+    }
 }
 
-Buffer::Buffer(Buffer&& buffer) : pimpl_(new Impl())
+Buffer::~Buffer(void)
 {
-    pimpl_->buffer_ = std::move(buffer.pimpl_->buffer_);
+    if (is_slice_ && pimpl_)
+    {
+        --pimpl_->slices_;
+    }
+}
+
+Buffer::Buffer(Buffer&& buffer)
+  : pimpl_(std::move(buffer.pimpl_)),
+    offset_(buffer.offset_),
+    length_(buffer.length_),
+    is_slice_(buffer.is_slice_)
+{
+    if (!pimpl_)
+    {
+        std::memcpy(inline_, buffer.inline_, length_);
+    }
+    buffer.pimpl_.reset();
+    buffer.offset_ = buffer.length_ = 0;
+    buffer.is_slice_ = false;
 }
 
 Buffer& Buffer::operator=(Buffer&& buffer)
 {
-    pimpl_->buffer_ = std::move(buffer.pimpl_->buffer_);
+    if (this != &buffer)
+    {
+        if (is_slice_ && pimpl_)
+        {
+            --pimpl_->slices_;
+        }
+        pimpl_ = std::move(buffer.pimpl_);
+        offset_ = buffer.offset_;
+        length_ = buffer.length_;
+        is_slice_ = buffer.is_slice_;
+        if (!pimpl_)
+        {
+            std::memcpy(inline_, buffer.inline_, length_);
+        }
+
+        buffer.pimpl_.reset();
+        buffer.offset_ = buffer.length_ = 0;
+        buffer.is_slice_ = false;
+    }
     return *this;
 }
 
+Buffer Buffer::slice(std::size_t offset, std::size_t length) const
+{
+    STDSC_THROW_INVPARAM_IF_CHECK(offset <= size() && length <= size() - offset,
+                                  "Slice is out of range.");
+    share();
+    Buffer buffer;
+    buffer.pimpl_ = pimpl_;
+    buffer.offset_ = offset_ + offset;
+    buffer.length_ = length;
+    buffer.is_slice_ = true;
+    ++pimpl_->slices_;
+    return buffer;
+}
+
+Buffer Buffer::slice(std::size_t offset) const
+{
+    STDSC_THROW_INVPARAM_IF_CHECK(offset <= size(), "Slice is out of range.");
+    return slice(offset, size() - offset);
+}
+
+bool Buffer::is_slice(void) const
+{
+    return is_slice_;
+}
+
+Buffer Buffer::take(void)
+{
+    return Buffer(std::move(*this));
+}
+
 void Buffer::resize(std::size_t size)
 {
-    pimpl_->buffer_.resize(size);
+    STDSC_THROW_FAILURE_IF_CHECK(!is_slice_, "Slice can not be resized.");
+    if (pimpl_)
+    {
+        STDSC_THROW_FAILURE_IF_CHECK(
+          pimpl_->slices_ == 0,
+          "Buffer can not be resized while its slices are alive.");
+        pimpl_->buffer_.resize(size);
+    }
+    else if (size <= STDSC_BUFFER_INLINE_SIZE)
+    {
+        if (length_ < size)
+        {
+            std::memset(inline_ + length_, 0, size - length_);
+        }
+        length_ = size;
+    }
+    else
+    {
+        auto impl = std::make_shared<Impl>(size);
+        std::memcpy(impl->buffer_.data(), inline_, length_);
+        pimpl_ = impl;
+        length_ = 0;
+    }
+}
+
+void Buffer::share(void) const
+{
+    if (!pimpl_)
+    {
+        /* the inline data is never a slice, so the offset is zero */
+        auto impl = std::make_shared<Impl>(length_);
+        std::memcpy(impl->buffer_.data(), inline_, length_);
+        pimpl_ = impl;
+        length_ = 0;
+    }
 }
 
 std::size_t Buffer::size(void) const
 {
-    return pimpl_->buffer_.size();
+    return (is_slice_ || !pimpl_) ? length_ : pimpl_->buffer_.size();
 }
 
 const void* Buffer::data(void) const
 {
-    return reinterpret_cast<const void*>(pimpl_->buffer_.data());
+    const uint8_t* p = pimpl_ ? pimpl_->buffer_.data() : inline_;
+    return reinterpret_cast<const void*>(p + offset_);
 }
 
 void* Buffer::data(void)
 {
-    return reinterpret_cast<void*>(pimpl_->buffer_.data());
+    uint8_t* p = pimpl_ ? pimpl_->buffer_.data() : inline_;
+    return reinterpret_cast<void*>(p + offset_);
 }
 
 /* BufferStream */
@@ -18,14 +18,26 @@
 #ifndef STDSC_BUFFER_HPP
 #define STDSC_BUFFER_HPP
 
+#include <cstdint>
 #include <memory>
 #include <iostream>
+#include <stdsc/stdsc_define.hpp>
 
 namespace stdsc
 {
 
 /**
  * @brief This class is used to hold the generic data.
+ *
+ * The copies and the slices of a buffer share its storage, and the writes
+ * through one of them are seen by all of them. The data up to
+ * STDSC_BUFFER_INLINE_SIZE bytes is stored inline without heap allocation
+ * until the buffer is first copied or sliced, which moves it to the heap.
+ * This invalidates the pointers returned by data() before, and must not
+ * race with other accesses to the buffer. take() never copies the data.
+ *
+ * resize() reallocates the storage, so it throws while slices of the
+ * storage are alive, rather than leave them pointing at the old data.
  */
 class Buffer
 {
@@ -36,14 +48,34 @@ public:
     explicit Buffer(std::size_t size);
     Buffer(std::size_t size, uint8_t val);
 
-    virtual ~Buffer(void) = default;
+    virtual ~Buffer(void);
 
-    Buffer(const Buffer&) = default;
+    Buffer(const Buffer& buffer);
     Buffer& operator=(const Buffer&) = delete;
 
     Buffer(Buffer&& buffer);
     Buffer& operator=(Buffer&& buffer);
 
+    /**
+     * Returns a view of [offset, offset + length) without copying.
+     * The view keeps the storage alive and can not be resized, and the
+     * storage can not be resized while the view is alive.
+     */
+    Buffer slice(std::size_t offset, std::size_t length) const;
+    Buffer slice(std::size_t offset) const;
+
+    bool is_slice(void) const;
+
+    /**
+     * Moves the storage out to the returned buffer without copying,
+     * leaving this buffer empty.
+     */
+    Buffer take(void);
+
+    /**
+     * Resizes the storage, which is seen by all the copies of the buffer.
+     * Throws FailureException on a slice, or while slices are alive.
+     */
     void resize(std::size_t size);
 
     std::size_t size(void) const;
@@ -55,8 +87,15 @@ public:
     void release(void);
 
 private:
+    /* Moves the inline data to the heap to share it. */
+    void share(void) const;
+
     struct Impl;
-    const std::shared_ptr<Impl> pimpl_;
+    mutable std::shared_ptr<Impl> pimpl_; ///< null if the data is inline
+    std::size_t offset_;
+    mutable std::size_t length_;  ///< size of the slice or the inline data
+    bool is_slice_;
+    alignas(16) uint8_t inline_[STDSC_BUFFER_INLINE_SIZE];
 };
 
 /**
@@ -70,6 +109,9 @@ public:
     BufferStream(void) = delete;
     BufferStream(std::size_t size);
     BufferStream(std::size_t size, uint8_t val);
+    /**
+     * Reads or writes the data of `buffer`, sharing its storage.
+     */
     BufferStream(const Buffer& buffer);
 
     virtual ~BufferStream(void) = default;
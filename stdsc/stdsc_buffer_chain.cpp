@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include <cstring>
+#include <stdsc/stdsc_buffer_chain.hpp>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+namespace stdsc
+{
+
+struct BufferChain::Impl
+{
+    Impl(void) : header_(1, 0), payload_size_(0)
+    {
+    }
+
+    void push_back(const Buffer& buffer)
+    {
+        segments_.push_back(buffer);
+        header_[0] = segments_.size();
+        header_.push_back(static_cast<uint64_t>(buffer.size()));
+        payload_size_ += buffer.size();
+    }
+
+    void clear(void)
+    {
+        segments_.clear();
+        header_.assign(1, 0);
+        payload_size_ = 0;
+    }
+
+    void split(const Buffer& buffer)
+    {
+        clear();
+
+        const std::size_t total = buffer.size();
+        STDSC_THROW_FAILURE_IF_CHECK(sizeof(uint64_t) <= total,
+                                     "Invalid buffer chain.");
+        uint64_t num;
+        std::memcpy(&num, buffer.data(), sizeof(num));
+        STDSC_THROW_FAILURE_IF_CHECK(
+          num < total / sizeof(uint64_t), "Invalid buffer chain.");
+
+        std::vector<uint64_t> sizes(num);
+        std::memcpy(sizes.data(),
+                    static_cast<const uint8_t*>(buffer.data()) + sizeof(num),
+                    num * sizeof(uint64_t));
+
+        std::size_t offset = (num + 1) * sizeof(uint64_t);
+        for (const auto& sz : sizes)
+        {
+            STDSC_THROW_FAILURE_IF_CHECK(sz <= total - offset,
+                                         "Invalid buffer chain.");
+            push_back(buffer.slice(offset, sz));
+            offset += sz;
+        }
+        STDSC_THROW_FAILURE_IF_CHECK(offset == total, "Invalid buffer chain.");
+    }
+
+    std::vector<Buffer> segments_;
+    std::vector<uint64_t> header_; ///< number of segments and their sizes
+    std::size_t payload_size_;
+};
+
+BufferChain::BufferChain(void) : pimpl_(new Impl())
+{
+}
+
+BufferChain::BufferChain(const Buffer& buffer) : pimpl_(new Impl())
+{
+    pimpl_->split(buffer);
+}
+
+void BufferChain::push_back(const Buffer& buffer)
+{
+    pimpl_->push_back(buffer);
+}
+
+void BufferChain::clear(void)
+{
+    pimpl_->clear();
+}
+
+std::size_t BufferChain::count(void) const
+{
+    return pimpl_->segments_.size();
+}
+
+const Buffer& BufferChain::at(std::size_t index) const
+{
+    STDSC_THROW_INVPARAM_IF_CHECK(index < pimpl_->segments_.size(),
+                                  "Segment index is out of range.");
+    return pimpl_->segments_[index];
+}
+
+std::size_t BufferChain::size(void) const
+{
+    return header_size() + pimpl_->payload_size_;
+}
+
+const void* BufferChain::header(void) const
+{
+    return pimpl_->header_.data();
+}
+
+std::size_t BufferChain::header_size(void) const
+{
+    return pimpl_->header_.size() * sizeof(uint64_t);
+}
+
+Buffer BufferChain::flatten(void) const
+{
+    Buffer buffer(size());
+    auto* p = static_cast<uint8_t*>(buffer.data());
+    std::memcpy(p, header(), header_size());
+    p += header_size();
+    for (const auto& seg : pimpl_->segments_)
+    {
+        std::memcpy(p, seg.data(), seg.size());
+        p += seg.size();
+    }
+    return buffer;
+}
+
+} /* namespace stdsc */
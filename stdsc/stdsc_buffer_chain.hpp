@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_BUFFER_CHAIN_HPP
+#define STDSC_BUFFER_CHAIN_HPP
+
+#include <cstdint>
+#include <memory>
+
+namespace stdsc
+{
+
+class Buffer;
+
+/**
+ * @brief This class is used to compose a payload of several buffers.
+ * The segments are transmitted as one payload by writev without being
+ * concatenated. The payload is framed as follows, so that the receiver can
+ * split it back into segments.
+ *   [number of segments (uint64_t)][size of each segment (uint64_t) x N]
+ *   [segment 0][segment 1] ... [segment N-1]
+ */
+class BufferChain
+{
+public:
+    BufferChain(void);
+    /**
+     * Splits the received payload into segments. The segments are slices of
+     * the buffer and share its storage. A payload which is not framed
+     * exactly throws FailureException.
+     */
+    explicit BufferChain(const Buffer& buffer);
+    virtual ~BufferChain(void) = default;
+
+    void push_back(const Buffer& buffer);
+    void clear(void);
+
+    std::size_t count(void) const;
+    const Buffer& at(std::size_t index) const;
+
+    /**
+     * Returns the size of the framed payload.
+     */
+    std::size_t size(void) const;
+
+    /**
+     * Returns the segment table which precedes the segments.
+     */
+    const void* header(void) const;
+    std::size_t header_size(void) const;
+
+    /**
+     * Returns the framed payload in one contiguous buffer.
+     */
+    Buffer flatten(void) const;
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_BUFFER_CHAIN_HPP */
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_BUFFER_CURSOR_HPP
+#define STDSC_BUFFER_CURSOR_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+namespace stdsc
+{
+
+/**
+ * @brief Provides a cursor to write typed values into Buffer.
+ * The buffer grows as needed, and is shrunk to the written size by finish().
+ */
+class BufferWriter
+{
+public:
+    explicit BufferWriter(Buffer& buffer, std::size_t offset = 0)
+      : buffer_(buffer),
+        ptr_(static_cast<uint8_t*>(buffer.data())),
+        pos_(offset),
+        capacity_(buffer.size())
+    {
+        STDSC_THROW_INVPARAM_IF_CHECK(offset <= capacity_,
+                                      "Offset is out of range.");
+    }
+
+    BufferWriter(const BufferWriter&) = delete;
+    BufferWriter& operator=(const BufferWriter&) = delete;
+
+    template <class T>
+    void put(const T& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "put requires trivially copyable type.");
+        reserve(sizeof(T));
+        std::memcpy(ptr_ + pos_, &v, sizeof(T));
+        pos_ += sizeof(T);
+    }
+
+    void write(const void* data, std::size_t size)
+    {
+        reserve(size);
+        std::memcpy(ptr_ + pos_, data, size);
+        pos_ += size;
+    }
+
+    /**
+     * Writes the unsigned value in LEB128.
+     */
+    void put_varint(uint64_t v)
+    {
+        reserve(10);
+        while (0x80 <= v)
+        {
+            ptr_[pos_++] = static_cast<uint8_t>(v | 0x80);
+            v >>= 7;
+        }
+        ptr_[pos_++] = static_cast<uint8_t>(v);
+    }
+
+    /**
+     * Writes the signed value in zigzag-encoded LEB128.
+     */
+    void put_svarint(int64_t v)
+    {
+        put_varint((static_cast<uint64_t>(v) << 1) ^
+                   static_cast<uint64_t>(v >> 63));
+    }
+
+    /**
+     * Makes room for `size` bytes and returns it. The bytes are regarded
+     * as written.
+     */
+    void* claim(std::size_t size)
+    {
+        reserve(size);
+        void* p = ptr_ + pos_;
+        pos_ += size;
+        return p;
+    }
+
+    void reserve(std::size_t size)
+    {
+        if (capacity_ - pos_ < size)
+        {
+            grow(size);
+        }
+    }
+
+    std::size_t position(void) const
+    {
+        return pos_;
+    }
+
+    void finish(void)
+    {
+        if (pos_ != capacity_)
+        {
+            buffer_.resize(pos_);
+            ptr_ = static_cast<uint8_t*>(buffer_.data());
+            capacity_ = pos_;
+        }
+    }
+
+private:
+    void grow(std::size_t size)
+    {
+        std::size_t capacity = std::max(capacity_ * 2, pos_ + size);
+        buffer_.resize(capacity);
+        ptr_ = static_cast<uint8_t*>(buffer_.data());
+        capacity_ = capacity;
+    }
+
+    Buffer& buffer_;
+    uint8_t* ptr_;
+    std::size_t pos_;
+    std::size_t capacity_;
+};
+
+/**
+ * @brief Provides a cursor to read typed values from Buffer.
+ * The reader holds a copy of the buffer, which keeps its storage alive.
+ * Reading beyond the end throws FailureException.
+ */
+class BufferReader
+{
+public:
+    explicit BufferReader(const Buffer& buffer, std::size_t offset = 0)
+      : buffer_(buffer),
+        ptr_(static_cast<const uint8_t*>(buffer_.data())),
+        pos_(offset),
+        size_(buffer_.size())
+    {
+        STDSC_THROW_INVPARAM_IF_CHECK(offset <= size_,
+                                      "Offset is out of range.");
+    }
+
+    BufferReader(const BufferReader&) = delete;
+    BufferReader& operator=(const BufferReader&) = delete;
+
+    template <class T>
+    T get(void)
+    {
+        T v;
+        get(v);
+        return v;
+    }
+
+    template <class T>
+    void get(T& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "get requires trivially copyable type.");
+        check(sizeof(T));
+        std::memcpy(&v, ptr_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+    }
+
+    void read(void* data, std::size_t size)
+    {
+        check(size);
+        std::memcpy(data, ptr_ + pos_, size);
+        pos_ += size;
+    }
+
+    /**
+     * Reads the unsigned value in LEB128. The values which do not fit in
+     * 64 bits throw FailureException.
+     */
+    uint64_t get_varint(void)
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            check(1);
+            uint8_t b = ptr_[pos_++];
+            /* the 10th byte holds the top bit only */
+            STDSC_THROW_FAILURE_IF_CHECK(shift < 63 || b <= 1,
+                                         "Invalid varint.");
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80))
+            {
+                return v;
+            }
+        }
+        STDSC_THROW_FAILURE("Invalid varint.");
+    }
+
+    int64_t get_svarint(void)
+    {
+        uint64_t v = get_varint();
+        return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+    }
+
+    /**
+     * Returns `size` bytes in place without skipping them.
+     */
+    const void* peek(std::size_t size) const
+    {
+        check(size);
+        return ptr_ + pos_;
+    }
+
+    /**
+     * Returns `size` bytes in place and skips them.
+     */
+    const void* skip(std::size_t size)
+    {
+        check(size);
+        const void* p = ptr_ + pos_;
+        pos_ += size;
+        return p;
+    }
+
+    /**
+     * Returns `size` bytes as a slice of the buffer, and skips them.
+     */
+    Buffer get_slice(std::size_t size)
+    {
+        check(size);
+        Buffer slice = buffer_.slice(pos_, size);
+        pos_ += size;
+        return slice;
+    }
+
+    std::size_t position(void) const
+    {
+        return pos_;
+    }
+
+    void seek(std::size_t position)
+    {
+        STDSC_THROW_INVPARAM_IF_CHECK(position <= size_,
+                                      "Position is out of range.");
+        pos_ = position;
+    }
+
+    std::size_t remaining(void) const
+    {
+        return size_ - pos_;
+    }
+
+private:
+    void check(std::size_t size) const
+    {
+        STDSC_THROW_FAILURE_IF_CHECK(size <= size_ - pos_,
+                                     "Read beyond the end of buffer.");
+    }
+
+    Buffer buffer_;
+    const uint8_t* ptr_;
+    std::size_t pos_;
+    std::size_t size_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_BUFFER_CURSOR_HPP */
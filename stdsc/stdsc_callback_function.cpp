@@ -49,6 +49,42 @@ void CallbackFunction::eval(uint64_t code, const Buffer& buffer,
     updownload_function(code, buffer, sock, state, cdata_on_each, cdata_on_all);
 }
 
+void CallbackFunction::eval_take(uint64_t code, Buffer& buffer,
+                                 StateContext& state,
+                                 void* cdata_on_each, void* cdata_on_all)
+{
+    take_data_function(code, buffer, state, cdata_on_each, cdata_on_all);
+}
+
+void CallbackFunction::eval_take(uint64_t code, Buffer& buffer,
+                                 const Socket& sock, StateContext& state,
+                                 void* cdata_on_each, void* cdata_on_all)
+{
+    take_updownload_function(code, buffer, sock, state, cdata_on_each,
+                             cdata_on_all);
+}
+
+void CallbackFunction::eval_stream(uint64_t code, std::istream& is,
+                                   std::size_t size, StateContext& state,
+                                   void* cdata_on_each, void* cdata_on_all)
+{
+    stream_data_function(code, is, size, state, cdata_on_each, cdata_on_all);
+}
+
+void CallbackFunction::eval_stream(uint64_t code, std::istream& is,
+                                   std::size_t size, const Socket& sock,
+                                   StateContext& state,
+                                   void* cdata_on_each, void* cdata_on_all)
+{
+    stream_updownload_function(code, is, size, sock, state, cdata_on_each,
+                               cdata_on_all);
+}
+
+bool CallbackFunction::streams_payload(void) const
+{
+    return false;
+}
+
 void CallbackFunction::request_function(uint64_t code, StateContext& state,
                                         void* cdata_on_each, void* cdata_on_all)
 {
@@ -76,4 +112,40 @@ void CallbackFunction::updownload_function(uint64_t code, const Buffer& buffer,
     STDSC_LOG_WARN("%s is not implemented.", __FUNCTION__);
 }
 
+void CallbackFunction::take_data_function(uint64_t code, Buffer& buffer,
+                                          StateContext& state,
+                                          void* cdata_on_each, void* cdata_on_all)
+{
+    data_function(code, buffer, state, cdata_on_each, cdata_on_all);
+}
+
+void CallbackFunction::take_updownload_function(uint64_t code, Buffer& buffer,
+                                                const Socket& sock,
+                                                StateContext& state,
+                                                void* cdata_on_each,
+                                                void* cdata_on_all)
+{
+    updownload_function(code, buffer, sock, state, cdata_on_each, cdata_on_all);
+}
+
+void CallbackFunction::stream_data_function(uint64_t code, std::istream& is,
+                                            std::size_t size,
+                                            StateContext& state,
+                                            void* cdata_on_each,
+                                            void* cdata_on_all)
+{
+    STDSC_LOG_WARN("%s is not implemented.", __FUNCTION__);
+}
+
+void CallbackFunction::stream_updownload_function(uint64_t code,
+                                                  std::istream& is,
+                                                  std::size_t size,
+                                                  const Socket& sock,
+                                                  StateContext& state,
+                                                  void* cdata_on_each,
+                                                  void* cdata_on_all)
+{
+    STDSC_LOG_WARN("%s is not implemented.", __FUNCTION__);
+}
+
 } /* stdsc */
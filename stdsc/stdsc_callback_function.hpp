@@ -19,6 +19,7 @@
 #define STDSC_CALLBACK_FUNCTION_HPP
 
 #include <cstdint>
+#include <iosfwd>
 #include <memory>
 
 #define DECLARE_REQUEST_CLASS(cls)                                      \
@@ -65,6 +66,64 @@
             void* cdata_on_each, void* cdata_on_all) override;          \
     }
 
+#define DECLARE_TAKE_DATA_CLASS(cls)                                    \
+    class cls : public stdsc::CallbackFunction                          \
+    {                                                                   \
+    protected:                                                          \
+        virtual void take_data_function(                                \
+            uint64_t code,                                              \
+            stdsc::Buffer& buffer,                                      \
+            stdsc::StateContext& state,                                 \
+            void* cdata_on_each, void* cdata_on_all) override;          \
+    }
+
+#define DECLARE_TAKE_UPDOWNLOAD_CLASS(cls)                              \
+    class cls : public stdsc::CallbackFunction                          \
+    {                                                                   \
+    protected:                                                          \
+        virtual void take_updownload_function(                          \
+            uint64_t code,                                              \
+            stdsc::Buffer& buffer,                                      \
+            const stdsc::Socket& sock,                                  \
+            stdsc::StateContext& state,                                 \
+            void* cdata_on_each, void* cdata_on_all) override;          \
+    }
+
+#define DECLARE_STREAM_DATA_CLASS(cls)                                  \
+    class cls : public stdsc::CallbackFunction                          \
+    {                                                                   \
+    public:                                                             \
+        virtual bool streams_payload(void) const override               \
+        {                                                               \
+            return true;                                                \
+        }                                                               \
+                                                                        \
+    protected:                                                          \
+        virtual void stream_data_function(                              \
+            uint64_t code,                                              \
+            std::istream& is, std::size_t size,                         \
+            stdsc::StateContext& state,                                 \
+            void* cdata_on_each, void* cdata_on_all) override;          \
+    }
+
+#define DECLARE_STREAM_UPDOWNLOAD_CLASS(cls)                            \
+    class cls : public stdsc::CallbackFunction                          \
+    {                                                                   \
+    public:                                                             \
+        virtual bool streams_payload(void) const override               \
+        {                                                               \
+            return true;                                                \
+        }                                                               \
+                                                                        \
+    protected:                                                          \
+        virtual void stream_updownload_function(                        \
+            uint64_t code,                                              \
+            std::istream& is, std::size_t size,                         \
+            const stdsc::Socket& sock,                                  \
+            stdsc::StateContext& state,                                 \
+            void* cdata_on_each, void* cdata_on_all) override;          \
+    }
+
 #define DEFUN_DATA(cls)                                                 \
     void cls::data_function(uint64_t code,                              \
                             const stdsc::Buffer& buffer,                \
@@ -89,6 +148,36 @@
                                   stdsc::StateContext& state,           \
                                   void* cdata_on_each, void* cdata_on_all)
 
+#define DEFUN_TAKE_DATA(cls)                                            \
+    void cls::take_data_function(uint64_t code,                         \
+                                 stdsc::Buffer& buffer,                 \
+                                 stdsc::StateContext& state,            \
+                                 void* cdata_on_each, void* cdata_on_all)
+
+#define DEFUN_TAKE_UPDOWNLOAD(cls)                                      \
+    void cls::take_updownload_function(uint64_t code,                   \
+                                       stdsc::Buffer& buffer,           \
+                                       const stdsc::Socket& sock,       \
+                                       stdsc::StateContext& state,      \
+                                       void* cdata_on_each,             \
+                                       void* cdata_on_all)
+
+#define DEFUN_STREAM_DATA(cls)                                          \
+    void cls::stream_data_function(uint64_t code,                       \
+                                   std::istream& is, std::size_t size,  \
+                                   stdsc::StateContext& state,          \
+                                   void* cdata_on_each,                 \
+                                   void* cdata_on_all)
+
+#define DEFUN_STREAM_UPDOWNLOAD(cls)                                    \
+    void cls::stream_updownload_function(uint64_t code,                 \
+                                         std::istream& is,              \
+                                         std::size_t size,              \
+                                         const stdsc::Socket& sock,     \
+                                         stdsc::StateContext& state,    \
+                                         void* cdata_on_each,           \
+                                         void* cdata_on_all)
+
 /* DEFINE_REQUEST_FUNC macro is deplicated in v2.x */
 #define DEFINE_REQUEST_FUNC(cls)                                        \
     void cls::request_function(uint64_t code,                           \
@@ -140,6 +229,33 @@ public:
     void eval(uint64_t code, const Buffer& buffer, const Socket& sock, StateContext& state,
               void* cdata_on_each=nullptr, void* cdata_on_all=nullptr);
 
+    /**
+     * Passes the received buffer to take_data_function() or
+     * take_updownload_function(), which may move it out.
+     */
+    void eval_take(uint64_t code, Buffer& buffer, StateContext& state,
+                   void* cdata_on_each=nullptr, void* cdata_on_all=nullptr);
+    void eval_take(uint64_t code, Buffer& buffer, const Socket& sock,
+                   StateContext& state,
+                   void* cdata_on_each=nullptr, void* cdata_on_all=nullptr);
+
+    /**
+     * Passes the payload of `size` bytes as it arrives to
+     * stream_data_function() or stream_updownload_function().
+     */
+    void eval_stream(uint64_t code, std::istream& is, std::size_t size,
+                     StateContext& state,
+                     void* cdata_on_each=nullptr, void* cdata_on_all=nullptr);
+    void eval_stream(uint64_t code, std::istream& is, std::size_t size,
+                     const Socket& sock, StateContext& state,
+                     void* cdata_on_each=nullptr, void* cdata_on_all=nullptr);
+
+    /**
+     * Returns true if the payload is received by eval_stream() instead of
+     * into a Buffer (DECLARE_STREAM_*_CLASS).
+     */
+    virtual bool streams_payload(void) const;
+
 protected:
     virtual void request_function(uint64_t code, StateContext& state,
                                   void* cdata_on_each, void* cdata_on_all);
@@ -152,6 +268,25 @@ protected:
     virtual void updownload_function(uint64_t code, const Buffer& buffer,
                                      const Socket& sock, StateContext& state,
                                      void* cdata_on_each, void* cdata_on_all);
+    /* The received buffer may be moved out by Buffer::take(). */
+    virtual void take_data_function(uint64_t code, Buffer& buffer,
+                                    StateContext& state,
+                                    void* cdata_on_each, void* cdata_on_all);
+    virtual void take_updownload_function(uint64_t code, Buffer& buffer,
+                                          const Socket& sock, StateContext& state,
+                                          void* cdata_on_each, void* cdata_on_all);
+    /* The bytes not read are discarded after the function returns. The
+     * upload must be read before sending the download, or both sides may
+     * block on full socket buffers. */
+    virtual void stream_data_function(uint64_t code, std::istream& is,
+                                      std::size_t size, StateContext& state,
+                                      void* cdata_on_each, void* cdata_on_all);
+    virtual void stream_updownload_function(uint64_t code, std::istream& is,
+                                            std::size_t size,
+                                            const Socket& sock,
+                                            StateContext& state,
+                                            void* cdata_on_each,
+                                            void* cdata_on_all);
 };
 } /* namespace stdsc */
 
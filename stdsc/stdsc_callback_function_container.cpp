@@ -26,6 +26,9 @@
 #include <stdsc/stdsc_socket.hpp>
 #include <stdsc/stdsc_buffer.hpp>
 #include <stdsc/stdsc_state.hpp>
+#include <stdsc/stdsc_stats.hpp>
+#include <stdsc/stdsc_streambuf.hpp>
+#include <stdsc/stdsc_exception.hpp>
 
 namespace stdsc
 {
@@ -45,7 +48,8 @@ struct CallbackFunctionContainer::Impl
         funcmap_.emplace(code, func);
     }
 
-    void eval(const Socket& sock, const Packet& packet, StateContext& state)
+    void eval(const Socket& sock, const Packet& packet, StateContext& state,
+              RequestTiming* timing)
     {
         cdatamap_.emplace(sock.connection_id(), cdata_on_each_);
         void* cdata_on_each = nullptr;
@@ -67,11 +71,25 @@ struct CallbackFunctionContainer::Impl
         {
             std::size_t buffer_size = packet.u_body.data.size;
             STDSC_LOG_TRACE("data size: %lu", buffer_size);
-            Buffer buffer(buffer_size);
-            sock.recv_buffer(buffer);
-            if (funcmap_.count(code))
+            if (is_stream(code))
+            {
+                auto& func = funcmap_[code];
+                recv_stream(sock, buffer_size, [&](std::istream& is) {
+                    func->eval_stream(code, is, buffer_size, state,
+                                      cdata_on_each, cdata_on_all);
+                });
+                mark(timing, &RequestTiming::payload);
+            }
+            else
             {
-                funcmap_[code]->eval(code, buffer, state, cdata_on_each, cdata_on_all);
+                Buffer buffer(buffer_size);
+                sock.recv_buffer(buffer);
+                mark(timing, &RequestTiming::payload);
+                if (funcmap_.count(code))
+                {
+                    funcmap_[code]->eval_take(code, buffer, state, cdata_on_each,
+                                              cdata_on_all);
+                }
             }
         }
         else if (code & kControlCodeGroupDownload)
@@ -85,14 +103,67 @@ struct CallbackFunctionContainer::Impl
         {
             std::size_t buffer_size = packet.u_body.data.size;
             STDSC_LOG_TRACE("data size: %lu", buffer_size);
-            Buffer buffer(buffer_size);
-            sock.recv_buffer(buffer);
-            if (funcmap_.count(code))
+            if (is_stream(code))
+            {
+                auto& func = funcmap_[code];
+                recv_stream(sock, buffer_size, [&](std::istream& is) {
+                    func->eval_stream(code, is, buffer_size, sock, state,
+                                      cdata_on_each, cdata_on_all);
+                });
+                mark(timing, &RequestTiming::payload);
+            }
+            else
             {
-                funcmap_[code]->eval(code, buffer, sock, state, cdata_on_each, cdata_on_all);
+                Buffer buffer(buffer_size);
+                sock.recv_buffer(buffer);
+                mark(timing, &RequestTiming::payload);
+                if (funcmap_.count(code))
+                {
+                    funcmap_[code]->eval_take(code, buffer, sock, state,
+                                              cdata_on_each, cdata_on_all);
+                }
             }
         }
-        
+        mark(timing, &RequestTiming::callback);
+    }
+
+    bool is_stream(const uint64_t code) const
+    {
+        auto it = funcmap_.find(code);
+        return it != funcmap_.end() && it->second->streams_payload();
+    }
+
+    /* Runs `func` on the payload as it arrives. The rest of the payload is
+     * discarded, also when the callback throws, so that the next packet is
+     * read from its start. A socket error leaves nothing to discard. */
+    template <class F>
+    static void recv_stream(const Socket& sock, const std::size_t size,
+                            const F& func)
+    {
+        SocketIStreamBuf sb(sock, size);
+        std::istream is(&sb);
+        try
+        {
+            func(is);
+        }
+        catch (const SocketException&)
+        {
+            throw;
+        }
+        catch (...)
+        {
+            sb.finish();
+            throw;
+        }
+        sb.finish();
+    }
+
+    static void mark(RequestTiming* timing, uint64_t RequestTiming::*point)
+    {
+        if (timing)
+        {
+            timing->*point = RequestTiming::now();
+        }
     }
 
     void set_commondata(const void* data, const size_t size, const CommonDataKind_t kind)
@@ -133,9 +204,10 @@ void CallbackFunctionContainer::set(uint64_t code,
 }
 
 void CallbackFunctionContainer::eval(const Socket& sock, const Packet& packet,
-                                        StateContext& state)
+                                        StateContext& state,
+                                        RequestTiming* timing)
 {
-    pimpl_->eval(sock, packet, state);
+    pimpl_->eval(sock, packet, state, timing);
 }
 
 void CallbackFunctionContainer::set_commondata(const void* data, const size_t size,
@@ -27,6 +27,7 @@ class CallbackFunction;
 class Socket;
 class StateContext;
 class Packet;
+struct RequestTiming;
 
 /**
  * @brief Enumeration for common data kind
@@ -48,7 +49,13 @@ public:
     CallbackFunctionContainer(void);
     virtual ~CallbackFunctionContainer(void);
     void set(uint64_t code, std::shared_ptr<CallbackFunction>& func);
-    void eval(const Socket& sock, const Packet& packet, StateContext& state);
+    /**
+     * Receives the payload of the packet and calls the function of the
+     * control code. If timing is given, its callback time point is set,
+     * and so is the payload time point if the packet has a payload.
+     */
+    void eval(const Socket& sock, const Packet& packet, StateContext& state,
+              RequestTiming* timing = nullptr);
     void set_commondata(const void* data, const size_t size,
                         const CommonDataKind_t kind=kCommonDataOnEachConnection);
 private:
@@ -24,6 +24,11 @@
 #include <stdsc/stdsc_packet.hpp>
 #include <stdsc/stdsc_exception.hpp>
 #include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_chain.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_stats.hpp>
+#include <stdsc/stdsc_trace.hpp>
+#include <stdsc/stdsc_streambuf.hpp>
 #include <stdsc/stdsc_define.hpp>
 
 namespace stdsc
@@ -52,9 +57,95 @@ static inline std::string count2str(uint32_t count)
     return oss.str();
 }
 
+/* records an attempt into the statistics at the end of the scope */
+class RequestRecord
+{
+public:
+    RequestRecord(ClientStats& stats, const Socket& sock, const uint64_t code)
+      : stats_(stats),
+        counters_(sock.counters()),
+        code_(code),
+        result_(kRequestResultFailure),
+        start_(RequestTiming::now()),
+        sent_(counters_.bytes_sent),
+        received_(counters_.bytes_received)
+    {
+    }
+
+    ~RequestRecord(void)
+    {
+        stats_.record(code_, RequestTiming::now() - start_,
+                      counters_.bytes_sent - sent_,
+                      counters_.bytes_received - received_, result_);
+    }
+
+    void set_ack(const uint64_t ack_code)
+    {
+        if (ack_code == kControlCodeAccept)
+        {
+            result_ = kRequestResultAccept;
+        }
+        else if (ack_code == kControlCodeReject)
+        {
+            result_ = kRequestResultReject;
+        }
+    }
+
+private:
+    ClientStats& stats_;
+    const SocketCounters& counters_;
+    const uint64_t code_;
+    RequestResult_t result_;
+    const uint64_t start_;
+    const uint64_t sent_;
+    const uint64_t received_;
+};
+
+/* calls `op` until it is accepted, sleeping between the rejected attempts */
+template <class F>
+static void retry_on_reject(ClientStats& stats, const uint64_t code,
+                            const uint32_t retry_interval_usec,
+                            const uint32_t timeout_sec, const char* what,
+                            const char* timeout_message, const F& op)
+{
+    const uint64_t start = RequestTiming::now();
+    bool is_success = false;
+    uint32_t retry_count = 0;
+
+    uint32_t max_retry_count =
+      calc_retry_count(timeout_sec, retry_interval_usec);
+
+    while (!is_success && max_retry_count > retry_count)
+    {
+        try
+        {
+            op();
+            is_success = true;
+        }
+        catch (const stdsc::RejectException& e)
+        {
+            retry_count++;
+            STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                           STDSC_LOG_RATE_BURST, "Retry to %s. (%d / %d)",
+                           what, retry_count, max_retry_count);
+            TraceSpan span("client.retry_sleep", code);
+            const uint64_t sleep_start = RequestTiming::now();
+            usleep(retry_interval_usec);
+            stats.record_retry(code, RequestTiming::now() - sleep_start);
+        }
+    }
+    stats.record_blocking(code, RequestTiming::now() - start);
+
+    STDSC_THROW_SOCKET_IF_CHECK(max_retry_count > retry_count,
+                                timeout_message);
+}
+
 struct Client::Impl
 {
     Impl(void)
+      : zerocopy_enabled_(false),
+        zerocopy_threshold_(0),
+        stats_(new ClientStats())
     {
     }
 
@@ -73,12 +164,17 @@ struct Client::Impl
           calc_retry_count(timeout_sec, retry_interval_usec);
 
         std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t start = RequestTiming::now();
         
         while (!is_success && max_retry_count > retry_count)
         {
             try
             {
                 sock_ = Socket::establish_connection(host, port);
+                if (zerocopy_enabled_)
+                {
+                    sock_.enable_zerocopy(zerocopy_threshold_);
+                }
                 is_success = true;
             }
             catch (const SocketException& e)
@@ -91,6 +187,8 @@ struct Client::Impl
             }
         }
 
+        stats_->record_connect(RequestTiming::now() - start, retry_count,
+                               is_success);
         STDSC_THROW_SOCKET_IF_CHECK(max_retry_count > retry_count,
                                     "Connection time out");
 
@@ -104,17 +202,50 @@ struct Client::Impl
         sock_.close();
     }
 
+    bool flush_zerocopy(const uint32_t timeout_sec)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sock_.flush_zerocopy(timeout_sec);
+    }
+
+    std::shared_ptr<ClientStats> stats(void) const
+    {
+        return stats_;
+    }
+
+    bool enable_zerocopy(const std::size_t threshold)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        zerocopy_enabled_ = true;
+        zerocopy_threshold_ = threshold;
+
+        /* not connected yet, it will be applied on connect */
+        if (sock_.connection_id() < 0)
+        {
+            return true;
+        }
+        return sock_.enable_zerocopy(threshold);
+    }
+
     void send_request(const uint64_t code)
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t request_id = Tracer::instance().next_request_id();
+        TraceSpan span("client.send_request", code, request_id);
+        RequestRecord record(*stats_, sock_, code);
         
+        span.phase("client.send");
         STDSC_LOG_TRACE("Send request packet. (code:0x%08x)", code);
         auto control_code = code;
         auto packet = make_packet(control_code);
+        set_request_id(packet, request_id);
         sock_.send_packet(packet);
 
+        span.phase("client.wait_ack");
         Packet ack;
         sock_.recv_packet(ack);
+        record.set_ack(ack.control_code);
         STDSC_LOG_TRACE("ack: 0x%x", ack.control_code);
 
         if (ack.control_code == kControlCodeReject)
@@ -133,19 +264,28 @@ struct Client::Impl
         }
     }
 
-    void send_data(const uint64_t code, const Buffer& buffer)
+    template <class B>
+    void send_data(const uint64_t code, const B& buffer)
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t request_id = Tracer::instance().next_request_id();
+        TraceSpan span("client.send_data", code, request_id);
+        RequestRecord record(*stats_, sock_, code);
         
+        span.phase("client.send");
         STDSC_LOG_TRACE("Send data packet. (code:0x%08x, sz:%lu)", code,
                         buffer.size());
         auto size = static_cast<uint64_t>(buffer.size());
         auto control_code = code;
-        sock_.send_packet(make_data_packet(control_code, size));
+        auto packet = make_data_packet(control_code, size);
+        set_request_id(packet, request_id);
+        sock_.send_packet(packet);
         sock_.send_buffer(buffer);
 
+        span.phase("client.wait_ack");
         Packet ack;
         sock_.recv_packet(ack);
+        record.set_ack(ack.control_code);
         STDSC_LOG_TRACE("ack: 0x%x", ack.control_code);
 
         if (ack.control_code == kControlCodeReject)
@@ -167,12 +307,18 @@ struct Client::Impl
     void recv_data(const uint64_t code, Buffer& buffer)
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t request_id = Tracer::instance().next_request_id();
+        TraceSpan span("client.recv_data", code, request_id);
+        RequestRecord record(*stats_, sock_, code);
         
+        span.phase("client.send");
         STDSC_LOG_TRACE("Send data request packet. (code:0x%08x)", code);
         auto control_code = code;
         auto packet = make_packet(control_code);
+        set_request_id(packet, request_id);
         sock_.send_packet(packet);
 
+        span.phase("client.recv");
         Packet recv_packet;
         sock_.recv_packet(recv_packet);
         auto size = static_cast<std::size_t>(recv_packet.u_body.data.size);
@@ -180,6 +326,7 @@ struct Client::Impl
                         recv_packet.control_code, size);
         if (recv_packet.control_code == kControlCodeReject)
         {
+            record.set_ack(recv_packet.control_code);
             std::ostringstream ss;
             ss << "Rejected to recv data. (0x" << std::hex
                << recv_packet.control_code << ")";
@@ -192,8 +339,10 @@ struct Client::Impl
             sock_.recv_buffer(buffer);
         }
 
+        span.phase("client.wait_ack");
         Packet ack;
         sock_.recv_packet(ack);
+        record.set_ack(ack.control_code);
         STDSC_LOG_TRACE("ack: 0x%x", ack.control_code);
 
         if (ack.control_code == kControlCodeReject)
@@ -212,17 +361,25 @@ struct Client::Impl
         }
     }
 
-    void send_recv_data(const uint64_t code, const Buffer& sbuffer, Buffer& rbuffer)
+    template <class B>
+    void send_recv_data(const uint64_t code, const B& sbuffer, Buffer& rbuffer)
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t request_id = Tracer::instance().next_request_id();
+        TraceSpan span("client.send_recv_data", code, request_id);
+        RequestRecord record(*stats_, sock_, code);
         
+        span.phase("client.send");
         STDSC_LOG_TRACE("Send data packet. (code:0x%08x, sz:%lu)", code,
                         sbuffer.size());
         auto ssize = static_cast<uint64_t>(sbuffer.size());
         auto control_code = code;
-        sock_.send_packet(make_data_packet(control_code, ssize));
+        auto packet = make_data_packet(control_code, ssize);
+        set_request_id(packet, request_id);
+        sock_.send_packet(packet);
         sock_.send_buffer(sbuffer);
 
+        span.phase("client.recv");
         Packet recv_packet;
         sock_.recv_packet(recv_packet);
         auto rsize = static_cast<std::size_t>(recv_packet.u_body.data.size);
@@ -230,6 +387,7 @@ struct Client::Impl
                         recv_packet.control_code, rsize);
         if (recv_packet.control_code == kControlCodeReject)
         {
+            record.set_ack(recv_packet.control_code);
             std::ostringstream ss;
             ss << "Rejected to recv data. (0x" << std::hex
                << recv_packet.control_code << ")";
@@ -242,8 +400,125 @@ struct Client::Impl
             sock_.recv_buffer(rbuffer);
         }
 
+        span.phase("client.wait_ack");
+        Packet ack;
+        sock_.recv_packet(ack);
+        record.set_ack(ack.control_code);
+        STDSC_LOG_TRACE("ack: 0x%x", ack.control_code);
+
+        if (ack.control_code == kControlCodeReject)
+        {
+            std::ostringstream ss;
+            ss << "Rejected to recv data. (0x" << std::hex << ack.control_code
+               << ")";
+            STDSC_THROW_REJECT(ss.str());
+        }
+        if (ack.control_code == kControlCodeFailed)
+        {
+            std::ostringstream ss;
+            ss << "Failed to recv data. (0x" << std::hex << ack.control_code
+               << ")";
+            STDSC_THROW_FAILURE(ss.str());
+        }
+    }
+
+    void send_stream(const uint64_t code, const std::size_t size,
+                     const std::function<void(std::ostream&)>& save)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t request_id = Tracer::instance().next_request_id();
+        TraceSpan span("client.send_stream", code, request_id);
+        RequestRecord record(*stats_, sock_, code);
+
+        span.phase("client.send");
+        STDSC_LOG_TRACE("Send data packet. (code:0x%08x, sz:%lu)", code, size);
+        auto control_code = code;
+        auto packet = make_data_packet(control_code, size);
+        set_request_id(packet, request_id);
+        sock_.send_packet(packet);
+        try
+        {
+            SocketOStreamBuf sb(sock_, size);
+            std::ostream os(&sb);
+            os.exceptions(std::ios::badbit);
+            save(os);
+            STDSC_THROW_FAILURE_IF_CHECK(!os.fail(),
+                                         "Failed to write the stream.");
+            sb.finish();
+        }
+        catch (...)
+        {
+            /* The server is still waiting for the rest of the payload, so
+             * the connection can not be used any more. */
+            STDSC_LOG_ERR("Failed to send stream. Closing the connection.");
+            sock_.close();
+            throw;
+        }
+
+        span.phase("client.wait_ack");
         Packet ack;
         sock_.recv_packet(ack);
+        record.set_ack(ack.control_code);
+        STDSC_LOG_TRACE("ack: 0x%x", ack.control_code);
+
+        if (ack.control_code == kControlCodeReject)
+        {
+            std::ostringstream ss;
+            ss << "Rejected to send data. (0x" << std::hex << ack.control_code
+               << ")";
+            STDSC_THROW_REJECT(ss.str());
+        }
+        if (ack.control_code == kControlCodeFailed)
+        {
+            std::ostringstream ss;
+            ss << "Failed to send data. (0x" << std::hex << ack.control_code
+               << ")";
+            STDSC_THROW_FAILURE(ss.str());
+        }
+    }
+
+    void recv_stream(const uint64_t code,
+                     const std::function<void(std::istream&)>& load)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t request_id = Tracer::instance().next_request_id();
+        TraceSpan span("client.recv_stream", code, request_id);
+        RequestRecord record(*stats_, sock_, code);
+
+        span.phase("client.send");
+        STDSC_LOG_TRACE("Send data request packet. (code:0x%08x)", code);
+        auto control_code = code;
+        auto packet = make_packet(control_code);
+        set_request_id(packet, request_id);
+        sock_.send_packet(packet);
+
+        span.phase("client.recv");
+        Packet recv_packet;
+        sock_.recv_packet(recv_packet);
+        auto size = static_cast<std::size_t>(recv_packet.u_body.data.size);
+        STDSC_LOG_TRACE("Received packet. (code:0x%08x, sz:%lu)",
+                        recv_packet.control_code, size);
+        if (recv_packet.control_code == kControlCodeReject)
+        {
+            record.set_ack(recv_packet.control_code);
+            std::ostringstream ss;
+            ss << "Rejected to recv data. (0x" << std::hex
+               << recv_packet.control_code << ")";
+            STDSC_THROW_REJECT(ss.str());
+        }
+
+        {
+            SocketIStreamBuf sb(sock_, size);
+            std::istream is(&sb);
+            is.exceptions(std::ios::badbit);
+            load(is);
+            sb.finish();
+        }
+
+        span.phase("client.wait_ack");
+        Packet ack;
+        sock_.recv_packet(ack);
+        record.set_ack(ack.control_code);
         STDSC_LOG_TRACE("ack: 0x%x", ack.control_code);
 
         if (ack.control_code == kControlCodeReject)
@@ -265,6 +540,9 @@ struct Client::Impl
 private:
     stdsc::Socket sock_;
     std::mutex mutex_;
+    bool zerocopy_enabled_;
+    std::size_t zerocopy_threshold_;
+    std::shared_ptr<ClientStats> stats_;
 };
 
 Client::Client(void) : pimpl_(new Impl())
@@ -287,6 +565,21 @@ void Client::close(void)
     pimpl_->close();
 }
 
+bool Client::enable_zerocopy(const std::size_t threshold)
+{
+    return pimpl_->enable_zerocopy(threshold);
+}
+
+bool Client::flush_zerocopy(const uint32_t timeout_sec)
+{
+    return pimpl_->flush_zerocopy(timeout_sec);
+}
+
+std::shared_ptr<ClientStats> Client::stats(void) const
+{
+    return pimpl_->stats();
+}
+
 void Client::send_request(const uint64_t code)
 {
     try
@@ -295,7 +588,8 @@ void Client::send_request(const uint64_t code)
     }
     catch (const stdsc::SocketException& e)
     {
-        STDSC_LOG_TRACE("Failed to send request.");
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to send request.");
     }
 }
 
@@ -307,7 +601,21 @@ void Client::send_data(const uint64_t code, const Buffer& buffer)
     }
     catch (const stdsc::SocketException& e)
     {
-        STDSC_LOG_TRACE("Failed to send data.");
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to send data.");
+    }
+}
+
+void Client::send_data(const uint64_t code, const BufferChain& chain)
+{
+    try
+    {
+        pimpl_->send_data(code, chain);
+    }
+    catch (const stdsc::SocketException& e)
+    {
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to send data.");
     }
 }
 
@@ -319,10 +627,29 @@ void Client::recv_data(const uint64_t code, Buffer& buffer)
     }
     catch (const stdsc::SocketException& e)
     {
-        STDSC_LOG_TRACE("Failed to recv data.");
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to recv data.");
     }
 }
 
+StatsSnapshot Client::recv_stats(void)
+{
+    Buffer buffer;
+    pimpl_->recv_data(kControlCodeStatistics, buffer);
+
+    StatsSnapshot snapshot;
+    BufferReader reader(buffer);
+    snapshot.load(reader);
+    return snapshot;
+}
+
+std::string Client::recv_flight_records(void)
+{
+    Buffer buffer;
+    pimpl_->recv_data(kControlCodeFlightRecords, buffer);
+    return std::string(static_cast<const char*>(buffer.data()), buffer.size());
+}
+
 void Client::send_recv_data(const uint64_t code, const Buffer& sbuffer, Buffer& rbuffer)
 {
     try
@@ -331,101 +658,86 @@ void Client::send_recv_data(const uint64_t code, const Buffer& sbuffer, Buffer&
     }
     catch (const stdsc::SocketException& e)
     {
-        STDSC_LOG_TRACE("Failed to recv data.");
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to recv data.");
     }
 }
 
-void Client::send_request_blocking(const uint64_t code,
-                                   const uint32_t retry_interval_usec,
-                                   const uint32_t timeout_sec)
+void Client::send_recv_data(const uint64_t code, const BufferChain& schain, Buffer& rbuffer)
 {
-    bool is_success = false;
-    uint32_t retry_count = 0;
+    try
+    {
+        pimpl_->send_recv_data(code, schain, rbuffer);
+    }
+    catch (const stdsc::SocketException& e)
+    {
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to recv data.");
+    }
+}
 
-    uint32_t max_retry_count =
-      calc_retry_count(timeout_sec, retry_interval_usec);
+void Client::send_stream(const uint64_t code, const std::size_t size,
+                         const std::function<void(std::ostream&)>& save)
+{
+    try
+    {
+        pimpl_->send_stream(code, size, save);
+    }
+    catch (const stdsc::SocketException& e)
+    {
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to send data.");
+    }
+}
 
-    while (!is_success && max_retry_count > retry_count)
+void Client::recv_stream(const uint64_t code,
+                         const std::function<void(std::istream&)>& load)
+{
+    try
     {
-        try
-        {
-            send_request(code);
-            is_success = true;
-        }
-        catch (const stdsc::RejectException& e)
-        {
-            retry_count++;
-            STDSC_LOG_TRACE("Retry to send request. (%d / %d)", retry_count,
-                            max_retry_count);
-            usleep(retry_interval_usec);
-            continue;
-        }
+        pimpl_->recv_stream(code, load);
+    }
+    catch (const stdsc::SocketException& e)
+    {
+        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                       STDSC_LOG_RATE_BURST, "Failed to recv data.");
     }
+}
 
-    STDSC_THROW_SOCKET_IF_CHECK(max_retry_count > retry_count,
-                                "Sending request time out");
+void Client::send_request_blocking(const uint64_t code,
+                                   const uint32_t retry_interval_usec,
+                                   const uint32_t timeout_sec)
+{
+    retry_on_reject(*pimpl_->stats(), code, retry_interval_usec, timeout_sec,
+                    "send request", "Sending request time out",
+                    [&] { send_request(code); });
 }
 
 void Client::send_data_blocking(const uint64_t code, const Buffer& buffer,
                                 const uint32_t retry_interval_usec,
                                 const uint32_t timeout_sec)
 {
-    bool is_success = false;
-    uint32_t retry_count = 0;
-
-    uint32_t max_retry_count =
-      calc_retry_count(timeout_sec, retry_interval_usec);
-
-    while (!is_success && max_retry_count > retry_count)
-    {
-        try
-        {
-            send_data(code, buffer);
-            is_success = true;
-        }
-        catch (const stdsc::RejectException& e)
-        {
-            retry_count++;
-            STDSC_LOG_TRACE("Retry to send data. (%d / %d)", retry_count,
-                            max_retry_count);
-            usleep(retry_interval_usec);
-            continue;
-        }
-    }
+    retry_on_reject(*pimpl_->stats(), code, retry_interval_usec, timeout_sec,
+                    "send data", "Sending data time out",
+                    [&] { send_data(code, buffer); });
+}
 
-    STDSC_THROW_SOCKET_IF_CHECK(max_retry_count > retry_count,
-                                "Sending data time out");
+void Client::send_data_blocking(const uint64_t code, const BufferChain& chain,
+                                const uint32_t retry_interval_usec,
+                                const uint32_t timeout_sec)
+{
+    retry_on_reject(*pimpl_->stats(), code, retry_interval_usec, timeout_sec,
+                    "send data", "Sending data time out",
+                    [&] { send_data(code, chain); });
 }
 
 void Client::recv_data_blocking(const uint64_t code, Buffer& buffer,
                                 const uint32_t retry_interval_usec,
                                 const uint32_t timeout_sec)
 {
-    bool is_success = false;
-    uint32_t retry_count = 0;
-
-    uint32_t max_retry_count =
-      calc_retry_count(timeout_sec, retry_interval_usec);
-
-    while (!is_success && max_retry_count > retry_count)
-    {
-        try
-        {
-            recv_data(code, buffer);
-            is_success = true;
-        }
-        catch (const stdsc::RejectException& e)
-        {
-            retry_count++;
-            STDSC_LOG_TRACE("Retry to recv data. (%d / %d)", retry_count,
-                            max_retry_count);
-            usleep(retry_interval_usec);
-            continue;
-        }
-    }
-
-    STDSC_THROW_SOCKET_IF_CHECK(max_retry_count > retry_count,
-                                "Receiving data time out");
+    retry_on_reject(*pimpl_->stats(), code, retry_interval_usec, timeout_sec,
+                    "recv data", "Receiving data time out",
+                    [&] { recv_data(code, buffer); });
 }
 
 void Client::send_recv_data_blocking(const uint64_t code,
@@ -433,31 +745,19 @@ void Client::send_recv_data_blocking(const uint64_t code,
                                      const uint32_t retry_interval_usec,
                                      const uint32_t timeout_sec)
 {
-    bool is_success = false;
-    uint32_t retry_count = 0;
-
-    uint32_t max_retry_count =
-      calc_retry_count(timeout_sec, retry_interval_usec);
-
-    while (!is_success && max_retry_count > retry_count)
-    {
-        try
-        {
-            send_recv_data(code, sbuffer, rbuffer);
-            is_success = true;
-        }
-        catch (const stdsc::RejectException& e)
-        {
-            retry_count++;
-            STDSC_LOG_TRACE("Retry to recv data. (%d / %d)", retry_count,
-                            max_retry_count);
-            usleep(retry_interval_usec);
-            continue;
-        }
-    }
+    retry_on_reject(*pimpl_->stats(), code, retry_interval_usec, timeout_sec,
+                    "recv data", "Receiving data time out",
+                    [&] { send_recv_data(code, sbuffer, rbuffer); });
+}
 
-    STDSC_THROW_SOCKET_IF_CHECK(max_retry_count > retry_count,
-                                "Receiving data time out");
+void Client::send_recv_data_blocking(const uint64_t code,
+                                     const BufferChain& schain, Buffer& rbuffer,
+                                     const uint32_t retry_interval_usec,
+                                     const uint32_t timeout_sec)
+{
+    retry_on_reject(*pimpl_->stats(), code, retry_interval_usec, timeout_sec,
+                    "recv data", "Receiving data time out",
+                    [&] { send_recv_data(code, schain, rbuffer); });
 }
 
 } /* namespace opsica_packet */
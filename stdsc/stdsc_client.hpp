@@ -19,12 +19,18 @@
 #define STDSC_CLIENT_HPP
 
 #include <memory>
+#include <functional>
+#include <iostream>
+#include <string>
 #include <stdsc/stdsc_define.hpp>
 
 namespace stdsc
 {
 
 class Buffer;
+class BufferChain;
+class ClientStats;
+struct StatsSnapshot;
 
 /**
  * @ brief Provides client functions.
@@ -41,10 +47,58 @@ public:
 
     void close(void);
 
+    /**
+     * Sends large buffers by MSG_ZEROCOPY (see Socket::enable_zerocopy).
+     * A sent Buffer must not be modified or resized until flush_zerocopy()
+     * returns.
+     */
+    bool enable_zerocopy(const std::size_t threshold = STDSC_ZEROCOPY_THRESHOLD);
+
+    /**
+     * Waits until the kernel has released all buffers sent by zero-copy.
+     * Returns false if timed out.
+     */
+    bool flush_zerocopy(const uint32_t timeout_sec = STDSC_TIME_INFINITE);
+
+    /**
+     * Returns the statistics of the requests sent by the client.
+     */
+    std::shared_ptr<ClientStats> stats(void) const;
+
     void send_request(const uint64_t code);
     void send_data(const uint64_t code, const Buffer& buffer);
+    void send_data(const uint64_t code, const BufferChain& chain);
     void recv_data(const uint64_t code, Buffer& buffer);
     void send_recv_data(const uint64_t code, const Buffer& sbuffer, Buffer& rbuffer);
+    void send_recv_data(const uint64_t code, const BufferChain& schain, Buffer& rbuffer);
+
+    /**
+     * Returns the statistics of the server (kControlCodeStatistics).
+     * Unlike the other requests, errors are thrown.
+     */
+    StatsSnapshot recv_stats(void);
+
+    /**
+     * Returns the text dump of the flight records of all connections of the
+     * server (kControlCodeFlightRecords). Errors are thrown as recv_stats().
+     */
+    std::string recv_flight_records(void);
+
+    /**
+     * Sends `size` bytes written by `save` (e.g. BasicData::save_to_stream)
+     * directly to the socket, without an intermediate buffer.
+     * If `save` throws, or writes more or less than `size` bytes, the
+     * connection is closed and the exception is rethrown before the ack
+     * is read, since the server can not find the end of the payload.
+     */
+    void send_stream(const uint64_t code, const std::size_t size,
+                     const std::function<void(std::ostream&)>& save);
+    /**
+     * Receives the data and passes it to `load`
+     * (e.g. BasicData::load_from_stream) as it arrives.
+     */
+    void recv_stream(const uint64_t code,
+                     const std::function<void(std::istream&)>& load);
 
     void send_request_blocking(const uint64_t code,
                                const uint32_t retry_interval_usec =
@@ -55,6 +109,10 @@ public:
                             const uint32_t retry_interval_usec =
                               STDSC_RETRY_INTERVAL_USEC,
                             const uint32_t timeout_sec = STDSC_TIME_INFINITE);
+    void send_data_blocking(const uint64_t code, const BufferChain& chain,
+                            const uint32_t retry_interval_usec =
+                              STDSC_RETRY_INTERVAL_USEC,
+                            const uint32_t timeout_sec = STDSC_TIME_INFINITE);
     void recv_data_blocking(const uint64_t code, Buffer& buffer,
                             const uint32_t retry_interval_usec =
                               STDSC_RETRY_INTERVAL_USEC,
@@ -64,6 +122,11 @@ public:
                                  const uint32_t retry_interval_usec =
                                  STDSC_RETRY_INTERVAL_USEC,
                                  const uint32_t timeout_sec = STDSC_TIME_INFINITE);
+    void send_recv_data_blocking(const uint64_t code,
+                                 const BufferChain& schain, Buffer& rbuffer,
+                                 const uint32_t retry_interval_usec =
+                                 STDSC_RETRY_INTERVAL_USEC,
+                                 const uint32_t timeout_sec = STDSC_TIME_INFINITE);
 
 private:
     struct Impl;
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <stdsc/stdsc_compute_pool.hpp>
+
+namespace stdsc
+{
+
+namespace
+{
+
+/* true while the thread runs a chunk of a loop */
+thread_local bool in_loop = false;
+
+/**
+ * @brief Marks the thread as running a loop in the scope.
+ */
+struct LoopScope
+{
+    LoopScope(void) : prev_(in_loop)
+    {
+        in_loop = true;
+    }
+    ~LoopScope(void)
+    {
+        in_loop = prev_;
+    }
+    bool prev_;
+};
+
+} /* namespace */
+
+struct ComputePool::Impl
+{
+    struct Job
+    {
+        Job(const std::function<void(std::size_t, std::size_t)>& func,
+            std::size_t begin, std::size_t end, std::size_t chunk_size)
+          : func(func),
+            begin(begin),
+            end(end),
+            chunks((end - begin + chunk_size - 1) / chunk_size),
+            chunk_size(chunk_size),
+            next(0),
+            done(0)
+        {
+        }
+
+        /**
+         * Runs chunks until none is left. Returns true if a chunk was run.
+         */
+        bool run(void)
+        {
+            bool ran = false;
+            LoopScope scope;
+            for (std::size_t i; (i = next++) < chunks;)
+            {
+                auto b = begin + i * chunk_size;
+                auto e = std::min(end, b + chunk_size);
+                try
+                {
+                    func(b, e);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+                ran = true;
+                if (++done == chunks)
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    cond.notify_all();
+                }
+            }
+            return ran;
+        }
+
+        bool exhausted(void) const
+        {
+            return chunks <= next;
+        }
+
+        void wait(void)
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cond.wait(lock, [this] { return done == chunks; });
+        }
+
+        const std::function<void(std::size_t, std::size_t)>& func;
+        const std::size_t begin;
+        const std::size_t end;
+        const std::size_t chunks;
+        const std::size_t chunk_size;
+        std::atomic<std::size_t> next;
+        std::atomic<std::size_t> done;
+        std::exception_ptr error;
+        std::mutex mtx;
+        std::condition_variable cond;
+    };
+
+    explicit Impl(std::size_t nthreads) : stop_(false)
+    {
+        if (nthreads == 0)
+        {
+            nthreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_ = nthreads;
+        for (std::size_t i = 1; i < nthreads; ++i)
+        {
+            threads_.emplace_back(&Impl::work, this);
+        }
+    }
+
+    ~Impl(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (auto& th : threads_)
+        {
+            th.join();
+        }
+    }
+
+    void work(void)
+    {
+        for (;;)
+        {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cond_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+                if (stop_)
+                {
+                    return;
+                }
+                job = jobs_.front();
+                if (job->exhausted())
+                {
+                    jobs_.pop_front();
+                    continue;
+                }
+            }
+            job->run();
+        }
+    }
+
+    void run(const std::function<void(std::size_t, std::size_t)>& func,
+             std::size_t begin, std::size_t end, std::size_t chunk_size)
+    {
+        auto job = std::make_shared<Job>(func, begin, end, chunk_size);
+        if (1 < job->chunks && !threads_.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                jobs_.push_back(job);
+            }
+            cond_.notify_all();
+        }
+
+        job->run();
+        job->wait();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = std::find(jobs_.begin(), jobs_.end(), job);
+            if (it != jobs_.end())
+            {
+                jobs_.erase(it);
+            }
+        }
+
+        if (job->error)
+        {
+            std::rethrow_exception(job->error);
+        }
+    }
+
+    std::size_t size_;
+    bool stop_;
+    std::deque<std::shared_ptr<Job>> jobs_;
+    std::vector<std::thread> threads_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+};
+
+ComputePool::ComputePool(const std::size_t nthreads)
+  : pimpl_(new Impl(nthreads))
+{
+}
+
+ComputePool::~ComputePool(void)
+{
+}
+
+ComputePool& ComputePool::instance(void)
+{
+    static ComputePool pool;
+    return pool;
+}
+
+std::size_t ComputePool::size(void) const
+{
+    return pimpl_->size_;
+}
+
+std::size_t ComputePool::chunk_size(const std::size_t n,
+                                    const std::size_t grain) const
+{
+    /* a few chunks per thread to balance uneven work */
+    const std::size_t chunks = in_loop ? 1 : pimpl_->size_ * 4;
+    /* the count is derived from the size, so that no chunk but the last
+     * is shorter than the grain, e.g. 9 elements of grain 4 take 2 chunks
+     * of 4 and 1, not 3 chunks of 3 */
+    return std::max<std::size_t>({1, grain, (n + chunks - 1) / chunks});
+}
+
+void ComputePool::parallel_for(
+  const std::size_t begin, const std::size_t end,
+  const std::function<void(std::size_t, std::size_t)>& func,
+  const std::size_t grain)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+    if (in_loop)
+    {
+        func(begin, end);
+        return;
+    }
+    pimpl_->run(func, begin, end, chunk_size(end - begin, grain));
+}
+
+} /* namespace stdsc */
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_COMPUTE_POOL_HPP
+#define STDSC_COMPUTE_POOL_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace stdsc
+{
+
+/**
+ * @brief Provides a pool of threads to run loops in parallel.
+ * The calling thread takes part in its own loop, so loops submitted from
+ * several threads at once progress without oversubscribing the pool.
+ * A loop called from inside another loop runs on the calling thread.
+ */
+class ComputePool
+{
+public:
+    /**
+     * @param[in] nthreads number of threads including the calling thread
+     *                     (0: number of cores)
+     */
+    explicit ComputePool(const std::size_t nthreads = 0);
+    ~ComputePool(void);
+
+    ComputePool(const ComputePool&) = delete;
+    ComputePool& operator=(const ComputePool&) = delete;
+
+    /**
+     * Returns the pool shared in the process, sized to the number of cores.
+     */
+    static ComputePool& instance(void);
+
+    /**
+     * Returns the number of threads including the calling thread.
+     */
+    std::size_t size(void) const;
+
+    /**
+     * Calls func(first, last) for the subranges of [begin, end), each of
+     * which has at least `grain` elements except the last. The first
+     * exception thrown by func is rethrown after the loop completes.
+     */
+    void parallel_for(const std::size_t begin, const std::size_t end,
+                      const std::function<void(std::size_t, std::size_t)>& func,
+                      const std::size_t grain = 1);
+
+    /**
+     * Reduces the results of map(first, last) for the subranges of
+     * [begin, end) with reduce, in order of the subranges.
+     */
+    template <class T, class Map, class Reduce>
+    T parallel_reduce(const std::size_t begin, const std::size_t end,
+                      const T init, Map map, Reduce reduce,
+                      const std::size_t grain = 1)
+    {
+        if (end <= begin)
+        {
+            return init;
+        }
+        const auto size = chunk_size(end - begin, grain);
+        const auto chunks = (end - begin + size - 1) / size;
+        std::vector<T> partials(chunks, init);
+        parallel_for(0, chunks, [&](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; ++i)
+            {
+                auto b = begin + i * size;
+                auto e = std::min(end, b + size);
+                partials[i] = map(b, e);
+            }
+        });
+        T result = init;
+        for (const auto& partial : partials)
+        {
+            result = reduce(result, partial);
+        }
+        return result;
+    }
+
+private:
+    /**
+     * Returns the number of elements per chunk to split n elements into.
+     * It is at least grain, and ceil(n / size) chunks cover n elements
+     * without an empty one.
+     */
+    std::size_t chunk_size(const std::size_t n, const std::size_t grain) const;
+
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_COMPUTE_POOL_HPP */
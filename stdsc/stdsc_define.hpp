@@ -25,4 +25,24 @@
 #define STDSC_TCP_BUFFER_SIZE (1 * 1024 * 1024)
 #define STDSC_CONN_TIMEOUT_SEC (30)
 
+#define STDSC_BUFFER_INLINE_SIZE (48)
+#define STDSC_STREAM_CHUNK_SIZE (1 * 1024 * 1024)
+#define STDSC_PARALLEL_SEGMENT_MIN_COUNT (64 * 1024)
+
+#define STDSC_ASYNC_WRITE_CHUNK_SIZE (4 * 1024 * 1024)
+#define STDSC_DIRECT_IO_ALIGNMENT (4096)
+
+#define STDSC_LOG_RING_SIZE (1024)
+#define STDSC_LOG_RATE_LIMIT (10)
+#define STDSC_LOG_RATE_BURST (20)
+
+#define STDSC_STATS_MAX_CODES (64)
+#define STDSC_STATS_PUBLISH_INTERVAL_MSEC (1000)
+
+#define STDSC_TRACE_MAX_EVENTS (256 * 1024)
+#define STDSC_FLIGHT_RECORDER_SIZE (256)
+
+#define STDSC_ZEROCOPY_THRESHOLD (1 * 1024 * 1024)
+#define STDSC_ZEROCOPY_FLUSH_TIMEOUT_SEC (10)
+
 #endif /* STDSC_DEFINE_HPP */
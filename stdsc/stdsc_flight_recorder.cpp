@@ -0,0 +1,277 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_log.hpp>
+#include <stdsc/stdsc_flight_recorder.hpp>
+
+namespace stdsc
+{
+
+namespace
+{
+
+/**
+ * @brief Slot of the ring. The fields are atomic only so that the readers
+ * may race with the recording thread; they are stored relaxed.
+ */
+struct FlightSlot
+{
+    std::atomic<uint64_t> code;
+    std::atomic<uint64_t> bytes_received;
+    std::atomic<uint64_t> bytes_sent;
+    std::atomic<uint64_t> begin_ns;
+    std::atomic<uint64_t> end_ns;
+    std::atomic<int32_t> state;
+    std::atomic<int32_t> result;
+};
+
+const char* result_str(const RequestResult_t result)
+{
+    switch (result)
+    {
+        case kRequestResultAccept:
+            return "accept";
+        case kRequestResultReject:
+            return "reject";
+        default:
+            return "failure";
+    }
+}
+
+/* the recorders alive, for dump_all() */
+std::mutex& registry_mutex(void)
+{
+    static std::mutex mtx;
+    return mtx;
+}
+
+std::vector<const FlightRecorder*>& registry(void)
+{
+    static std::vector<const FlightRecorder*> recorders;
+    return recorders;
+}
+
+void log_text(const std::string& text)
+{
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line))
+    {
+        STDSC_LOG_WARN("%s", line.c_str());
+    }
+}
+
+/* written by the signal handler to wake up the dumping thread */
+int g_signal_pipe[2] = {-1, -1};
+
+void on_signal(int)
+{
+    const int saved = errno;
+    const char c = 0;
+    if (write(g_signal_pipe[1], &c, 1) < 0)
+    {
+        /* the dump is already requested if the pipe is full */
+    }
+    errno = saved;
+}
+
+void dump_on_wakeup(void)
+{
+    char c;
+    while (0 < read(g_signal_pipe[0], &c, 1))
+    {
+        std::ostringstream oss;
+        FlightRecorder::dump_all(oss);
+        log_text(oss.str());
+    }
+}
+
+} /* namespace */
+
+struct FlightRecorder::Impl
+{
+    Impl(const int connection_id, const std::size_t capacity)
+      : connection_id_(connection_id), begun_(0), done_(0)
+    {
+        /* the capacity is rounded up to a power of two to mask the index */
+        std::size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots_ = std::vector<FlightSlot>(size);
+        mask_ = size - 1;
+    }
+
+    const int connection_id_;
+    std::vector<FlightSlot> slots_;
+    std::size_t mask_;
+    std::atomic<uint64_t> begun_; ///< records started to be written
+    std::atomic<uint64_t> done_;  ///< records written
+};
+
+FlightRecorder::FlightRecorder(const int connection_id,
+                               const std::size_t capacity)
+  : pimpl_(new Impl(connection_id, capacity))
+{
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry().push_back(this);
+}
+
+FlightRecorder::~FlightRecorder(void)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    auto& recorders = registry();
+    recorders.erase(std::remove(recorders.begin(), recorders.end(), this),
+                    recorders.end());
+}
+
+void FlightRecorder::record(const uint64_t code,
+                            const uint64_t bytes_received,
+                            const uint64_t bytes_sent,
+                            const uint64_t begin_ns, const uint64_t end_ns,
+                            const int32_t state,
+                            const RequestResult_t result)
+{
+    auto& impl = *pimpl_;
+    const uint64_t n = impl.done_.load(std::memory_order_relaxed);
+
+    /* tells the readers that the oldest slot is being overwritten */
+    impl.begun_.store(n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto& slot = impl.slots_[n & impl.mask_];
+    slot.code.store(code, std::memory_order_relaxed);
+    slot.bytes_received.store(bytes_received, std::memory_order_relaxed);
+    slot.bytes_sent.store(bytes_sent, std::memory_order_relaxed);
+    slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.state.store(state, std::memory_order_relaxed);
+    slot.result.store(result, std::memory_order_relaxed);
+
+    impl.done_.store(n + 1, std::memory_order_release);
+}
+
+std::vector<FlightRecord> FlightRecorder::records(void) const
+{
+    const auto& impl = *pimpl_;
+    const uint64_t capacity = impl.slots_.size();
+    const uint64_t done = impl.done_.load(std::memory_order_acquire);
+    const uint64_t first = (capacity < done) ? done - capacity : 0;
+
+    std::vector<FlightRecord> records;
+    records.reserve(done - first);
+    for (uint64_t seq = first; seq < done; ++seq)
+    {
+        const auto& slot = impl.slots_[seq & impl.mask_];
+        FlightRecord record;
+        record.seq = seq;
+        record.code = slot.code.load(std::memory_order_relaxed);
+        record.bytes_received =
+          slot.bytes_received.load(std::memory_order_relaxed);
+        record.bytes_sent = slot.bytes_sent.load(std::memory_order_relaxed);
+        record.begin_ns = slot.begin_ns.load(std::memory_order_relaxed);
+        record.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+        record.state = slot.state.load(std::memory_order_relaxed);
+        record.result = static_cast<RequestResult_t>(
+          slot.result.load(std::memory_order_relaxed));
+        records.push_back(record);
+    }
+
+    /* drops the records overwritten while being copied */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t begun = impl.begun_.load(std::memory_order_relaxed);
+    const uint64_t valid = (capacity < begun) ? begun - capacity : 0;
+    records.erase(records.begin(),
+                  std::find_if(records.begin(), records.end(),
+                               [valid](const FlightRecord& record) {
+                                   return valid <= record.seq;
+                               }));
+    return records;
+}
+
+void FlightRecorder::dump(std::ostream& os) const
+{
+    const auto records = this->records();
+    const uint64_t now = RequestTiming::now();
+    char line[256];
+    snprintf(line, sizeof(line),
+             "flight recorder of connection %d: last %zu requests\n",
+             pimpl_->connection_id_, records.size());
+    os << line;
+    for (const auto& r : records)
+    {
+        const uint64_t duration =
+          (r.begin_ns < r.end_ns) ? r.end_ns - r.begin_ns : 0;
+        const uint64_t ago = (r.begin_ns < now) ? now - r.begin_ns : 0;
+        snprintf(line, sizeof(line),
+                 "  #%" PRIu64 " code:0x%08" PRIx64 " state:%d result:%s"
+                 " recv:%" PRIu64 " sent:%" PRIu64 " duration:%" PRIu64
+                 " ns started:%" PRIu64 " us ago\n",
+                 r.seq, r.code, r.state, result_str(r.result),
+                 r.bytes_received, r.bytes_sent, duration, ago / 1000);
+        os << line;
+    }
+}
+
+void FlightRecorder::log(void) const
+{
+    std::ostringstream oss;
+    dump(oss);
+    log_text(oss.str());
+}
+
+void FlightRecorder::dump_all(std::ostream& os)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    for (const auto* recorder : registry())
+    {
+        recorder->dump(os);
+    }
+}
+
+void FlightRecorder::log_on_signal(const int signo)
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        STDSC_THROW_FAILURE_IF_CHECK(0 == pipe(g_signal_pipe),
+                                     "Failed to create pipe.");
+        fcntl(g_signal_pipe[1], F_SETFL, O_NONBLOCK);
+        std::thread(dump_on_wakeup).detach();
+    });
+
+    struct sigaction action;
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    STDSC_THROW_FAILURE_IF_CHECK(0 == sigaction(signo, &action, nullptr),
+                                 "Failed to set signal handler.");
+}
+
+} /* namespace stdsc */
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_FLIGHT_RECORDER_HPP
+#define STDSC_FLIGHT_RECORDER_HPP
+
+#include <csignal>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+#include <stdsc/stdsc_define.hpp>
+#include <stdsc/stdsc_stats.hpp>
+
+namespace stdsc
+{
+
+/**
+ * @brief A request processed by a connection thread.
+ */
+struct FlightRecord
+{
+    uint64_t seq;            ///< serial number in the connection
+    uint64_t code;           ///< control code
+    uint64_t bytes_received; ///< bytes received including the packet
+    uint64_t bytes_sent;     ///< bytes sent including the ack
+    uint64_t begin_ns;       ///< data of the packet arrived
+                             ///< (RequestTiming::now())
+    uint64_t end_ns;         ///< accept or reject sent
+    int32_t state;           ///< StateContext::current_state() at the end
+    RequestResult_t result;
+};
+
+/**
+ * @brief Keeps the last requests of a connection in a fixed-size ring.
+ * The connection thread records without locks or allocation, and the other
+ * threads may read the ring at any time; the records overwritten while
+ * being read are skipped. The recorders alive can be dumped all at once.
+ */
+class FlightRecorder
+{
+public:
+    explicit FlightRecorder(const int connection_id,
+                            const std::size_t capacity =
+                              STDSC_FLIGHT_RECORDER_SIZE);
+    ~FlightRecorder(void);
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * This must be called by one thread.
+     */
+    void record(const uint64_t code, const uint64_t bytes_received,
+                const uint64_t bytes_sent, const uint64_t begin_ns,
+                const uint64_t end_ns, const int32_t state,
+                const RequestResult_t result);
+
+    /**
+     * Returns the records from the oldest.
+     */
+    std::vector<FlightRecord> records(void) const;
+
+    void dump(std::ostream& os) const;
+
+    /**
+     * Writes the dump into the log at warning level.
+     */
+    void log(void) const;
+
+    /**
+     * Dumps the recorders of all connections alive.
+     */
+    static void dump_all(std::ostream& os);
+
+    /**
+     * Writes the dump of all recorders into the log whenever the process
+     * receives the signal. The handler only wakes up a thread which writes
+     * the dump.
+     */
+    static void log_on_signal(const int signo = SIGUSR2);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_FLIGHT_RECORDER_HPP */
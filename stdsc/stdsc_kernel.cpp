@@ -0,0 +1,464 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STDSC_KERNEL_X86
+#endif
+#include <stdsc/stdsc_kernel.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+#define STDSC_TARGET_AVX2 __attribute__((target("avx2")))
+#define STDSC_TARGET_AVX512 __attribute__((target("avx512f")))
+
+namespace stdsc
+{
+
+namespace kernel
+{
+
+namespace
+{
+
+/* Operations, with their scalar definitions. */
+
+struct AddOp
+{
+    template <class T>
+    static T scalar(const T a, const T b, const T)
+    {
+        return a + b;
+    }
+};
+
+struct SubOp
+{
+    template <class T>
+    static T scalar(const T a, const T b, const T)
+    {
+        return a - b;
+    }
+};
+
+struct XorOp
+{
+    template <class T>
+    static T scalar(const T a, const T b, const T)
+    {
+        return a ^ b;
+    }
+};
+
+struct AddModOp
+{
+    template <class T>
+    static T scalar(const T a, const T b, const T m)
+    {
+        T s = a + b;
+        return s >= m ? s - m : s;
+    }
+};
+
+struct SubModOp
+{
+    template <class T>
+    static T scalar(const T a, const T b, const T m)
+    {
+        return a >= b ? a - b : a - b + m;
+    }
+};
+
+/* b is the same as a for the unary operation. */
+struct ModReduceOp
+{
+    template <class T>
+    static T scalar(const T a, const T, const T m)
+    {
+        return a >= m ? a - m : a;
+    }
+};
+
+struct Scalar
+{
+    template <class T, class Op>
+    static void map(const T* a, const T* b, T* out, std::size_t n, const T m)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = Op::scalar(a[i], b[i], m);
+        }
+    }
+};
+
+#ifdef STDSC_KERNEL_X86
+
+/*
+ * add_mod and mod_reduce are written with unsigned minimum: for x < 2m,
+ * min(x, x - m) is x - m if x >= m, and x otherwise, since x - m wraps
+ * around to a value greater than x. sub_mod adds m in the lanes where
+ * a < b instead, since min(d, d + m) fails when d + m wraps around for
+ * m > 2^(bits-1).
+ */
+
+struct AVX2
+{
+    using V = __m256i;
+
+    STDSC_TARGET_AVX2 static V set1(const uint32_t v)
+    {
+        return _mm256_set1_epi32(static_cast<int>(v));
+    }
+    STDSC_TARGET_AVX2 static V set1(const uint64_t v)
+    {
+        return _mm256_set1_epi64x(static_cast<long long>(v));
+    }
+    STDSC_TARGET_AVX2 static V add(const V a, const V b, uint32_t)
+    {
+        return _mm256_add_epi32(a, b);
+    }
+    STDSC_TARGET_AVX2 static V add(const V a, const V b, uint64_t)
+    {
+        return _mm256_add_epi64(a, b);
+    }
+    STDSC_TARGET_AVX2 static V sub(const V a, const V b, uint32_t)
+    {
+        return _mm256_sub_epi32(a, b);
+    }
+    STDSC_TARGET_AVX2 static V sub(const V a, const V b, uint64_t)
+    {
+        return _mm256_sub_epi64(a, b);
+    }
+    STDSC_TARGET_AVX2 static V min(const V a, const V b, uint32_t)
+    {
+        return _mm256_min_epu32(a, b);
+    }
+    STDSC_TARGET_AVX2 static V min(const V a, const V b, uint64_t t)
+    {
+        return _mm256_blendv_epi8(a, b, less(b, a, t));
+    }
+    /* no unsigned comparison in AVX2: flip the sign bits */
+    STDSC_TARGET_AVX2 static V less(const V a, const V b, uint32_t)
+    {
+        const V bias = _mm256_set1_epi32(static_cast<int>(1U << 31));
+        return _mm256_cmpgt_epi32(_mm256_xor_si256(b, bias),
+                                  _mm256_xor_si256(a, bias));
+    }
+    STDSC_TARGET_AVX2 static V less(const V a, const V b, uint64_t)
+    {
+        const V bias = _mm256_set1_epi64x(static_cast<long long>(1ULL << 63));
+        return _mm256_cmpgt_epi64(_mm256_xor_si256(b, bias),
+                                  _mm256_xor_si256(a, bias));
+    }
+
+    template <class T>
+    STDSC_TARGET_AVX2 static V apply(AddOp, const V a, const V b, const V, T t)
+    {
+        return add(a, b, t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX2 static V apply(SubOp, const V a, const V b, const V, T t)
+    {
+        return sub(a, b, t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX2 static V apply(XorOp, const V a, const V b, const V, T)
+    {
+        return _mm256_xor_si256(a, b);
+    }
+    template <class T>
+    STDSC_TARGET_AVX2 static V apply(AddModOp, const V a, const V b,
+                                     const V m, T t)
+    {
+        V s = add(a, b, t);
+        return min(s, sub(s, m, t), t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX2 static V apply(SubModOp, const V a, const V b,
+                                     const V m, T t)
+    {
+        V d = sub(a, b, t);
+        return add(d, _mm256_and_si256(m, less(a, b, t)), t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX2 static V apply(ModReduceOp, const V a, const V,
+                                     const V m, T t)
+    {
+        return min(a, sub(a, m, t), t);
+    }
+
+    template <class T, class Op>
+    STDSC_TARGET_AVX2 static void map(const T* a, const T* b, T* out,
+                                      std::size_t n, const T m)
+    {
+        const std::size_t lanes = sizeof(V) / sizeof(T);
+        const V vm = set1(m);
+        std::size_t i = 0;
+        for (; i + lanes <= n; i += lanes)
+        {
+            V va = _mm256_loadu_si256(reinterpret_cast<const V*>(a + i));
+            V vb = _mm256_loadu_si256(reinterpret_cast<const V*>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<V*>(out + i),
+                                apply(Op(), va, vb, vm, T()));
+        }
+        for (; i < n; ++i)
+        {
+            out[i] = Op::scalar(a[i], b[i], m);
+        }
+    }
+};
+
+struct AVX512
+{
+    using V = __m512i;
+
+    STDSC_TARGET_AVX512 static V set1(const uint32_t v)
+    {
+        return _mm512_set1_epi32(static_cast<int>(v));
+    }
+    STDSC_TARGET_AVX512 static V set1(const uint64_t v)
+    {
+        return _mm512_set1_epi64(static_cast<long long>(v));
+    }
+    STDSC_TARGET_AVX512 static V add(const V a, const V b, uint32_t)
+    {
+        return _mm512_add_epi32(a, b);
+    }
+    STDSC_TARGET_AVX512 static V add(const V a, const V b, uint64_t)
+    {
+        return _mm512_add_epi64(a, b);
+    }
+    STDSC_TARGET_AVX512 static V sub(const V a, const V b, uint32_t)
+    {
+        return _mm512_sub_epi32(a, b);
+    }
+    STDSC_TARGET_AVX512 static V sub(const V a, const V b, uint64_t)
+    {
+        return _mm512_sub_epi64(a, b);
+    }
+    /* the masked forms avoid -Wmaybe-uninitialized in the GCC headers */
+    STDSC_TARGET_AVX512 static V min(const V a, const V b, uint32_t)
+    {
+        return _mm512_mask_min_epu32(a, static_cast<__mmask16>(-1), a, b);
+    }
+    STDSC_TARGET_AVX512 static V min(const V a, const V b, uint64_t)
+    {
+        return _mm512_mask_min_epu64(a, static_cast<__mmask8>(-1), a, b);
+    }
+    /* d + m in the lanes where a < b, d in the others */
+    STDSC_TARGET_AVX512 static V add_if_less(const V d, const V m, const V a,
+                                             const V b, uint32_t)
+    {
+        return _mm512_mask_add_epi32(d, _mm512_cmplt_epu32_mask(a, b), d, m);
+    }
+    STDSC_TARGET_AVX512 static V add_if_less(const V d, const V m, const V a,
+                                             const V b, uint64_t)
+    {
+        return _mm512_mask_add_epi64(d, _mm512_cmplt_epu64_mask(a, b), d, m);
+    }
+
+    template <class T>
+    STDSC_TARGET_AVX512 static V apply(AddOp, const V a, const V b, const V,
+                                       T t)
+    {
+        return add(a, b, t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX512 static V apply(SubOp, const V a, const V b, const V,
+                                       T t)
+    {
+        return sub(a, b, t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX512 static V apply(XorOp, const V a, const V b, const V,
+                                       T)
+    {
+        return _mm512_xor_si512(a, b);
+    }
+    template <class T>
+    STDSC_TARGET_AVX512 static V apply(AddModOp, const V a, const V b,
+                                       const V m, T t)
+    {
+        V s = add(a, b, t);
+        return min(s, sub(s, m, t), t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX512 static V apply(SubModOp, const V a, const V b,
+                                       const V m, T t)
+    {
+        return add_if_less(sub(a, b, t), m, a, b, t);
+    }
+    template <class T>
+    STDSC_TARGET_AVX512 static V apply(ModReduceOp, const V a, const V,
+                                       const V m, T t)
+    {
+        return min(a, sub(a, m, t), t);
+    }
+
+    template <class T, class Op>
+    STDSC_TARGET_AVX512 static void map(const T* a, const T* b, T* out,
+                                        std::size_t n, const T m)
+    {
+        const std::size_t lanes = sizeof(V) / sizeof(T);
+        const V vm = set1(m);
+        std::size_t i = 0;
+        for (; i + lanes <= n; i += lanes)
+        {
+            V va = _mm512_loadu_si512(a + i);
+            V vb = _mm512_loadu_si512(b + i);
+            _mm512_storeu_si512(out + i, apply(Op(), va, vb, vm, T()));
+        }
+        for (; i < n; ++i)
+        {
+            out[i] = Op::scalar(a[i], b[i], m);
+        }
+    }
+};
+
+#endif /* STDSC_KERNEL_X86 */
+
+KernelIsa_t detect_isa(void)
+{
+#ifdef STDSC_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return kKernelIsaAVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return kKernelIsaAVX2;
+    }
+#endif
+    return kKernelIsaScalar;
+}
+
+std::atomic<int32_t>& current_isa(void)
+{
+    static std::atomic<int32_t> isa(detect_isa());
+    return isa;
+}
+
+template <class T, class Op>
+void dispatch(const T* a, const T* b, T* out, std::size_t n, const T m = T())
+{
+    switch (current_isa().load(std::memory_order_relaxed))
+    {
+#ifdef STDSC_KERNEL_X86
+        case kKernelIsaAVX512:
+            AVX512::map<T, Op>(a, b, out, n, m);
+            break;
+        case kKernelIsaAVX2:
+            AVX2::map<T, Op>(a, b, out, n, m);
+            break;
+#endif
+        default:
+            Scalar::map<T, Op>(a, b, out, n, m);
+            break;
+    }
+}
+
+} /* namespace */
+
+KernelIsa_t detected_isa(void)
+{
+    static const KernelIsa_t isa = detect_isa();
+    return isa;
+}
+
+KernelIsa_t isa(void)
+{
+    return static_cast<KernelIsa_t>(current_isa().load());
+}
+
+void set_isa(const KernelIsa_t isa)
+{
+    STDSC_THROW_INVPARAM_IF_CHECK(
+      kKernelIsaScalar <= isa && isa <= detected_isa(),
+      "Instruction set is not supported.");
+    current_isa() = isa;
+}
+
+void add(const uint32_t* a, const uint32_t* b, uint32_t* out, std::size_t n)
+{
+    dispatch<uint32_t, AddOp>(a, b, out, n);
+}
+
+void add(const uint64_t* a, const uint64_t* b, uint64_t* out, std::size_t n)
+{
+    dispatch<uint64_t, AddOp>(a, b, out, n);
+}
+
+void sub(const uint32_t* a, const uint32_t* b, uint32_t* out, std::size_t n)
+{
+    dispatch<uint32_t, SubOp>(a, b, out, n);
+}
+
+void sub(const uint64_t* a, const uint64_t* b, uint64_t* out, std::size_t n)
+{
+    dispatch<uint64_t, SubOp>(a, b, out, n);
+}
+
+void bitwise_xor(const uint32_t* a, const uint32_t* b, uint32_t* out,
+                 std::size_t n)
+{
+    dispatch<uint32_t, XorOp>(a, b, out, n);
+}
+
+void bitwise_xor(const uint64_t* a, const uint64_t* b, uint64_t* out,
+                 std::size_t n)
+{
+    dispatch<uint64_t, XorOp>(a, b, out, n);
+}
+
+void add_mod(const uint32_t* a, const uint32_t* b, uint32_t* out,
+             std::size_t n, uint32_t m)
+{
+    dispatch<uint32_t, AddModOp>(a, b, out, n, m);
+}
+
+void add_mod(const uint64_t* a, const uint64_t* b, uint64_t* out,
+             std::size_t n, uint64_t m)
+{
+    dispatch<uint64_t, AddModOp>(a, b, out, n, m);
+}
+
+void sub_mod(const uint32_t* a, const uint32_t* b, uint32_t* out,
+             std::size_t n, uint32_t m)
+{
+    dispatch<uint32_t, SubModOp>(a, b, out, n, m);
+}
+
+void sub_mod(const uint64_t* a, const uint64_t* b, uint64_t* out,
+             std::size_t n, uint64_t m)
+{
+    dispatch<uint64_t, SubModOp>(a, b, out, n, m);
+}
+
+void mod_reduce(const uint32_t* a, uint32_t* out, std::size_t n, uint32_t m)
+{
+    dispatch<uint32_t, ModReduceOp>(a, a, out, n, m);
+}
+
+void mod_reduce(const uint64_t* a, uint64_t* out, std::size_t n, uint64_t m)
+{
+    dispatch<uint64_t, ModReduceOp>(a, a, out, n, m);
+}
+
+} /* namespace kernel */
+
+} /* namespace stdsc */
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_KERNEL_HPP
+#define STDSC_KERNEL_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+namespace stdsc
+{
+
+/**
+ * @brief Enumeration for instruction sets of kernels.
+ */
+enum KernelIsa_t : int32_t
+{
+    kKernelIsaScalar = 0,
+    kKernelIsaAVX2   = 1,
+    kKernelIsaAVX512 = 2,
+};
+
+/**
+ * Element-wise kernels over arrays of unsigned integers.
+ * The best instruction set supported by the CPU is selected at runtime.
+ * The output may alias the inputs. The modular kernels require the inputs
+ * to be less than the modulus `m`, and add_mod requires `m` to be at most
+ * 2^(bits-1).
+ */
+namespace kernel
+{
+
+/**
+ * Returns the best instruction set supported by the CPU.
+ */
+KernelIsa_t detected_isa(void);
+
+/**
+ * Returns the instruction set used by the kernels.
+ */
+KernelIsa_t isa(void);
+
+/**
+ * Sets the instruction set used by the kernels. It must be supported by
+ * the CPU.
+ */
+void set_isa(const KernelIsa_t isa);
+
+void add(const uint32_t* a, const uint32_t* b, uint32_t* out, std::size_t n);
+void add(const uint64_t* a, const uint64_t* b, uint64_t* out, std::size_t n);
+void sub(const uint32_t* a, const uint32_t* b, uint32_t* out, std::size_t n);
+void sub(const uint64_t* a, const uint64_t* b, uint64_t* out, std::size_t n);
+void bitwise_xor(const uint32_t* a, const uint32_t* b, uint32_t* out,
+                 std::size_t n);
+void bitwise_xor(const uint64_t* a, const uint64_t* b, uint64_t* out,
+                 std::size_t n);
+
+/** out = (a + b) mod m */
+void add_mod(const uint32_t* a, const uint32_t* b, uint32_t* out,
+             std::size_t n, uint32_t m);
+void add_mod(const uint64_t* a, const uint64_t* b, uint64_t* out,
+             std::size_t n, uint64_t m);
+
+/** out = (a - b) mod m */
+void sub_mod(const uint32_t* a, const uint32_t* b, uint32_t* out,
+             std::size_t n, uint32_t m);
+void sub_mod(const uint64_t* a, const uint64_t* b, uint64_t* out,
+             std::size_t n, uint64_t m);
+
+/**
+ * Reduces the values less than 2m to [0, m), as after a lazy addition.
+ */
+void mod_reduce(const uint32_t* a, uint32_t* out, std::size_t n, uint32_t m);
+void mod_reduce(const uint64_t* a, uint64_t* out, std::size_t n, uint64_t m);
+
+/**
+ * Returns the number of elements of type T in the buffers, which must have
+ * the same size.
+ */
+template <class T>
+std::size_t element_count(const Buffer& a, const Buffer& b, const Buffer& out)
+{
+    STDSC_THROW_INVPARAM_IF_CHECK(
+      a.size() == b.size() && a.size() == out.size(),
+      "Buffer sizes are mismatched.");
+    STDSC_THROW_INVPARAM_IF_CHECK(a.size() % sizeof(T) == 0,
+                                  "Buffer size is not a multiple of element.");
+    return a.size() / sizeof(T);
+}
+
+template <class T>
+void add(const Buffer& a, const Buffer& b, Buffer& out)
+{
+    auto n = element_count<T>(a, b, out);
+    add(static_cast<const T*>(a.data()), static_cast<const T*>(b.data()),
+        static_cast<T*>(out.data()), n);
+}
+
+template <class T>
+void sub(const Buffer& a, const Buffer& b, Buffer& out)
+{
+    auto n = element_count<T>(a, b, out);
+    sub(static_cast<const T*>(a.data()), static_cast<const T*>(b.data()),
+        static_cast<T*>(out.data()), n);
+}
+
+template <class T>
+void bitwise_xor(const Buffer& a, const Buffer& b, Buffer& out)
+{
+    auto n = element_count<T>(a, b, out);
+    bitwise_xor(static_cast<const T*>(a.data()),
+                static_cast<const T*>(b.data()), static_cast<T*>(out.data()),
+                n);
+}
+
+template <class T>
+void add_mod(const Buffer& a, const Buffer& b, Buffer& out, const T m)
+{
+    auto n = element_count<T>(a, b, out);
+    add_mod(static_cast<const T*>(a.data()), static_cast<const T*>(b.data()),
+            static_cast<T*>(out.data()), n, m);
+}
+
+template <class T>
+void sub_mod(const Buffer& a, const Buffer& b, Buffer& out, const T m)
+{
+    auto n = element_count<T>(a, b, out);
+    sub_mod(static_cast<const T*>(a.data()), static_cast<const T*>(b.data()),
+            static_cast<T*>(out.data()), n, m);
+}
+
+template <class T>
+void mod_reduce(const Buffer& a, Buffer& out, const T m)
+{
+    auto n = element_count<T>(a, a, out);
+    mod_reduce(static_cast<const T*>(a.data()), static_cast<T*>(out.data()),
+               n, m);
+}
+
+} /* namespace kernel */
+
+} /* namespace stdsc */
+
+#endif /* STDSC_KERNEL_HPP */
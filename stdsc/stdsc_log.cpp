@@ -16,18 +16,29 @@
  */
 
 #include <stdarg.h>
+#include <stdio.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <iostream>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
 
 #include <stdsc/stdsc_log.hpp>
 #include <stdsc/stdsc_utility.hpp>
+#include <stdsc/stdsc_exception.hpp>
 
 #define STDSC_LOG_MAX_LENGTH (1024 * 5)
 #define STDSC_LOG_LEVEL_ENV "STDSC_LOG_LEVEL"
 #define STDSC_DEFAULT_LOG_LEVEL stdsc::kLogLevelInfo
+#define STDSC_LOG_RECORD_SIZE (512)
+#define STDSC_LOG_WRITER_INTERVAL_MSEC (10)
 
 namespace stdsc
 {
@@ -62,17 +73,472 @@ static std::string make_debuginfo(const char* source_file_name,
     return ss.str();
 }
 
+/**
+ * @brief Message in the ring buffer of asynchronous logging.
+ * The file and function names point to string literals.
+ */
+struct LogRecord
+{
+    const char* file;
+    const char* func;
+    int32_t line;   ///< site ID in binary record
+    uint16_t length;
+    bool debuginfo;
+    bool binary;    ///< text holds time and arguments if true
+    char text[STDSC_LOG_RECORD_SIZE - 2 * sizeof(const char*) - 8];
+};
+
+static_assert(sizeof(uint64_t) + STDSC_LOG_ARGS_SIZE <= sizeof(LogRecord::text),
+              "Arguments of binary log do not fit in a record.");
+
+namespace
+{
+
+std::mutex& sites_mutex(void)
+{
+    static std::mutex mtx;
+    return mtx;
+}
+
+std::vector<const LogSite*>& sites(void)
+{
+    static std::vector<const LogSite*> vec;
+    return vec;
+}
+
+template <class T>
+void append_value(std::string& batch, const T v)
+{
+    batch.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void append_string(std::string& batch, const char* s)
+{
+    auto len = static_cast<uint16_t>(std::min<std::size_t>(std::strlen(s), 0xFFFF));
+    append_value(batch, len);
+    batch.append(s, len);
+}
+
+} /* namespace */
+
+LogSite::LogSite(const int level, const char* file, const char* func,
+                 const int line, const char* format)
+  : level(level), file(file), func(func), line(line), format(format)
+{
+    std::lock_guard<std::mutex> lock(sites_mutex());
+    id = static_cast<uint32_t>(sites().size());
+    sites().push_back(this);
+}
+
+const LogSite* LogSite::find(const uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(sites_mutex());
+    return id < sites().size() ? sites()[id] : nullptr;
+}
+
+/**
+ * @brief Single-producer single-consumer ring buffer of a thread.
+ */
+struct LogRing
+{
+    explicit LogRing(const std::size_t size)
+      : records(size), mask(size - 1), tail(0), head(0), closed(false)
+    {
+    }
+
+    std::vector<LogRecord> records;
+    const std::size_t mask;
+    std::atomic<uint64_t> tail; ///< written by the producer
+    char pad[64];
+    std::atomic<uint64_t> head; ///< written by the consumer
+    std::atomic<bool> closed;   ///< set when the producer thread exits
+};
+
+/**
+ * @brief Writes the messages in the ring buffers on a background thread.
+ */
+class AsyncLogBackend
+{
+public:
+    AsyncLogBackend(const std::string& filepath, std::size_t ring_size,
+                    const LogOverflowPolicy_t policy, const bool binary)
+      : ring_size_(1),
+        policy_(policy),
+        binary_(binary),
+        generation_(++generations_),
+        dropped_(0),
+        stop_(false),
+        sleeping_(false),
+        fp_(stdout)
+    {
+        while (ring_size_ < ring_size)
+        {
+            ring_size_ <<= 1;
+        }
+        if (!filepath.empty())
+        {
+            fp_ = fopen(filepath.c_str(), binary ? "wb" : "a");
+            STDSC_THROW_FILE_IF_CHECK(fp_ != nullptr,
+                                      "Failed to open log file. (" +
+                                        filepath + ")");
+        }
+        if (binary)
+        {
+            std::string header;
+            append_value(header, STDSC_LOG_BINARY_MAGIC);
+            append_value(header, STDSC_LOG_BINARY_VERSION);
+            append_value(header, uint16_t(0));
+            fwrite(header.data(), 1, header.size(), fp_);
+            fflush(fp_);
+        }
+        th_ = std::thread(&AsyncLogBackend::run, this);
+    }
+
+    ~AsyncLogBackend(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        th_.join();
+        if (fp_ != stdout)
+        {
+            fclose(fp_);
+        }
+    }
+
+    void emit(const char* file, const char* func, int line, bool debuginfo,
+              const char* format, va_list ap)
+    {
+        LogRing* ring;
+        uint64_t tail;
+        LogRecord* rec = reserve(ring, tail);
+        if (!rec)
+        {
+            return;
+        }
+        rec->file = file;
+        rec->func = func;
+        rec->line = line;
+        rec->debuginfo = debuginfo;
+        rec->binary = false;
+        int n = vsnprintf(rec->text, sizeof(rec->text), format, ap);
+        if (n < 0)
+        {
+            n = 0;
+        }
+        rec->length = static_cast<uint16_t>(
+          std::min<std::size_t>(static_cast<std::size_t>(n),
+                                sizeof(rec->text) - 1));
+        publish(*ring, tail);
+    }
+
+    void emit_binary(const LogSite& site, bool debuginfo, const void* args,
+                     const std::size_t size)
+    {
+        LogRing* ring;
+        uint64_t tail;
+        LogRecord* rec = reserve(ring, tail);
+        if (!rec)
+        {
+            return;
+        }
+        uint64_t now = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+        rec->line = static_cast<int32_t>(site.id);
+        rec->debuginfo = debuginfo;
+        rec->binary = true;
+        std::memcpy(rec->text, &now, sizeof(now));
+        std::memcpy(rec->text + sizeof(now), args, size);
+        rec->length = static_cast<uint16_t>(sizeof(now) + size);
+        publish(*ring, tail);
+    }
+
+    void flush(void)
+    {
+        std::vector<std::pair<std::shared_ptr<LogRing>, uint64_t>> targets;
+        {
+            std::lock_guard<std::mutex> lock(rings_mtx_);
+            for (auto& ring : rings_)
+            {
+                targets.emplace_back(ring, ring->tail.load());
+            }
+        }
+        for (auto& target : targets)
+        {
+            while (target.first->head.load() < target.second)
+            {
+                notify();
+                std::unique_lock<std::mutex> lock(mtx_);
+                done_.wait_for(lock, std::chrono::milliseconds(
+                                       STDSC_LOG_WRITER_INTERVAL_MSEC));
+            }
+        }
+    }
+
+    uint64_t dropped_count(void) const
+    {
+        return dropped_.load();
+    }
+
+private:
+    /**
+     * @brief Holds the ring buffer of the thread, and closes it when the
+     * thread exits.
+     */
+    struct LocalRing
+    {
+        LocalRing(void) : generation(0)
+        {
+        }
+        ~LocalRing(void)
+        {
+            if (ring)
+            {
+                ring->closed = true;
+            }
+        }
+        std::shared_ptr<LogRing> ring;
+        uint64_t generation;
+    };
+
+    LogRing& local_ring(void)
+    {
+        static thread_local LocalRing local;
+        if (local.generation != generation_)
+        {
+            if (local.ring)
+            {
+                local.ring->closed = true;
+            }
+            local.ring = std::make_shared<LogRing>(ring_size_);
+            local.generation = generation_;
+            std::lock_guard<std::mutex> lock(rings_mtx_);
+            rings_.push_back(local.ring);
+        }
+        return *local.ring;
+    }
+
+    /**
+     * Returns the next entry of the ring of the thread, or nullptr if the
+     * message is dropped.
+     */
+    LogRecord* reserve(LogRing*& ring, uint64_t& tail)
+    {
+        ring = &local_ring();
+        tail = ring->tail.load(std::memory_order_relaxed);
+        while (ring->head.load(std::memory_order_acquire) + ring_size_ <= tail)
+        {
+            if (policy_ == kLogOverflowDrop)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            notify();
+            std::this_thread::yield();
+        }
+        return &ring->records[tail & ring->mask];
+    }
+
+    void publish(LogRing& ring, const uint64_t tail)
+    {
+        ring.tail.store(tail + 1, std::memory_order_release);
+
+        /* the writer polls the rings, and is woken early only if this
+         * ring is filling up */
+        if (ring_size_ / 2 <= tail + 1 - ring.head.load(std::memory_order_relaxed) &&
+            sleeping_.load(std::memory_order_relaxed))
+        {
+            notify();
+        }
+    }
+
+    void notify(void)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        wake_.notify_one();
+    }
+
+    void run(void)
+    {
+        std::string batch;
+        for (;;)
+        {
+            bool stop;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                stop = stop_;
+            }
+            bool written = drain(batch);
+            done_.notify_all();
+            if (stop && !written)
+            {
+                return;
+            }
+            if (!written)
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                sleeping_ = true;
+                wake_.wait_for(lock, std::chrono::milliseconds(
+                                       STDSC_LOG_WRITER_INTERVAL_MSEC));
+                sleeping_ = false;
+            }
+        }
+    }
+
+    /**
+     * Writes the messages in all ring buffers in one batch, then releases
+     * the entries. Returns true if any message was written.
+     */
+    bool drain(std::string& batch)
+    {
+        std::vector<std::pair<std::shared_ptr<LogRing>, uint64_t>> taken;
+        {
+            std::lock_guard<std::mutex> lock(rings_mtx_);
+            for (auto it = rings_.begin(); it != rings_.end();)
+            {
+                auto& ring = *it;
+                bool closed = ring->closed.load();
+                uint64_t tail = ring->tail.load(std::memory_order_acquire);
+                uint64_t head = ring->head.load(std::memory_order_relaxed);
+                if (head != tail)
+                {
+                    taken.emplace_back(ring, tail);
+                }
+                else if (closed)
+                {
+                    it = rings_.erase(it);
+                    continue;
+                }
+                ++it;
+            }
+        }
+        if (taken.empty())
+        {
+            return false;
+        }
+
+        batch.clear();
+        for (auto& t : taken)
+        {
+            auto& ring = *t.first;
+            for (uint64_t i = ring.head.load(); i < t.second; ++i)
+            {
+                append(batch, ring.records[i & ring.mask]);
+            }
+        }
+        fwrite(batch.data(), 1, batch.size(), fp_);
+        fflush(fp_);
+
+        for (auto& t : taken)
+        {
+            t.first->head.store(t.second, std::memory_order_release);
+        }
+        return true;
+    }
+
+    void append(std::string& batch, const LogRecord& rec)
+    {
+        if (binary_)
+        {
+            append_frame(batch, rec);
+            return;
+        }
+        append_line(batch, rec);
+    }
+
+    static void append_line(std::string& batch, const LogRecord& rec)
+    {
+        batch.append(rec.text, rec.length);
+        if (rec.length < 48)
+        {
+            batch.append(48 - rec.length, ' ');
+        }
+        if (rec.debuginfo)
+        {
+            batch += make_debuginfo(rec.file, rec.func, rec.line);
+        }
+        batch += '\n';
+    }
+
+    void append_frame(std::string& batch, const LogRecord& rec)
+    {
+        if (!rec.binary)
+        {
+            std::string line;
+            append_line(line, rec);
+            line.pop_back();
+            batch += static_cast<char>(kLogFrameText);
+            append_value(batch, static_cast<uint16_t>(line.size()));
+            batch += line;
+            return;
+        }
+
+        const auto id = static_cast<uint32_t>(rec.line);
+        if (written_sites_.size() <= id)
+        {
+            written_sites_.resize(id + 1, false);
+        }
+        if (!written_sites_[id])
+        {
+            const LogSite* site = LogSite::find(id);
+            batch += static_cast<char>(kLogFrameSite);
+            append_value(batch, id);
+            append_value(batch, static_cast<uint32_t>(site->level));
+            append_value(batch, static_cast<uint32_t>(site->line));
+            append_string(batch, site->file);
+            append_string(batch, site->func);
+            append_string(batch, site->format);
+            written_sites_[id] = true;
+        }
+
+        batch += static_cast<char>(kLogFrameMessage);
+        append_value(batch, id);
+        append_value(batch, static_cast<uint8_t>(rec.debuginfo));
+        batch.append(rec.text, sizeof(uint64_t));
+        append_value(batch, static_cast<uint16_t>(rec.length - sizeof(uint64_t)));
+        batch.append(rec.text + sizeof(uint64_t), rec.length - sizeof(uint64_t));
+    }
+
+    std::size_t ring_size_;
+    const LogOverflowPolicy_t policy_;
+    const bool binary_;
+    std::vector<bool> written_sites_;
+    const uint64_t generation_;
+    std::atomic<uint64_t> dropped_;
+    bool stop_;
+    std::atomic<bool> sleeping_;
+    FILE* fp_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::mutex rings_mtx_;
+    std::mutex mtx_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::thread th_;
+
+    static std::atomic<uint64_t> generations_;
+};
+
+std::atomic<uint64_t> AsyncLogBackend::generations_(0);
+
 struct Logger::Impl
 {
-    Impl(void) : current_level_(STDSC_DEFAULT_LOG_LEVEL)
+    Impl(void) : current_level_(STDSC_DEFAULT_LOG_LEVEL), async_(nullptr)
     {
     }
-    ~Impl(void) = default;
+    ~Impl(void)
+    {
+        delete async_.load();
+    }
     LogLevel_t current_level_;
+    std::atomic<AsyncLogBackend*> async_;
     static std::mutex mutex_;
 };
 
-Logger::Logger(void) : pimpl_(new Impl())
+Logger::Logger(void) : binary_(false), pimpl_(new Impl())
 {
 }
 
@@ -98,6 +564,17 @@ void Logger::emit(const LogLevel_t level, const char* source_file_name,
         return;
     }
 
+    auto* async = pimpl_->async_.load(std::memory_order_acquire);
+    if (async)
+    {
+        va_list ap;
+        va_start(ap, format);
+        async->emit(source_file_name, func_name, source_line_number,
+                    pimpl_->current_level_ >= kLogLevelDebug, format, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(Impl::mutex_);
 
     char message_buffer[STDSC_LOG_MAX_LENGTH];
@@ -120,9 +597,83 @@ void Logger::emit(const LogLevel_t level, const char* source_file_name,
 void Logger::set_level(const LogLevel_t level)
 {
     pimpl_->current_level_ = level;
+    g_log_level.store(level, std::memory_order_relaxed);
+}
+
+void Logger::enable_async(const std::string& filepath,
+                          const std::size_t ring_size,
+                          const LogOverflowPolicy_t policy)
+{
+    std::cout.flush();
+    auto* async = new AsyncLogBackend(filepath, ring_size, policy, false);
+    binary_ = false;
+    delete pimpl_->async_.exchange(async);
+}
+
+void Logger::enable_binary(const std::string& filepath,
+                           const std::size_t ring_size,
+                           const LogOverflowPolicy_t policy)
+{
+    STDSC_THROW_INVPARAM_IF_CHECK(!filepath.empty(),
+                                  "Binary log needs a file.");
+    std::cout.flush();
+    auto* async = new AsyncLogBackend(filepath, ring_size, policy, true);
+    delete pimpl_->async_.exchange(async);
+    binary_ = true;
+}
+
+void Logger::disable_async(void)
+{
+    binary_ = false;
+    delete pimpl_->async_.exchange(nullptr);
+}
+
+bool Logger::is_binary(void) const
+{
+    return binary_;
+}
+
+void Logger::emit_binary(const LogSite& site, const void* args,
+                         const std::size_t size) const
+{
+    if (pimpl_->current_level_ < site.level)
+    {
+        return;
+    }
+    auto* async = pimpl_->async_.load(std::memory_order_acquire);
+    if (async)
+    {
+        async->emit_binary(site, pimpl_->current_level_ >= kLogLevelDebug,
+                           args, size);
+    }
+}
+
+bool Logger::is_async(void) const
+{
+    return pimpl_->async_.load() != nullptr;
+}
+
+void Logger::flush(void) const
+{
+    auto* async = pimpl_->async_.load();
+    if (async)
+    {
+        async->flush();
+    }
+    else
+    {
+        std::cout.flush();
+    }
+}
+
+uint64_t Logger::dropped_count(void) const
+{
+    auto* async = pimpl_->async_.load();
+    return async ? async->dropped_count() : 0;
 }
 
 Logger* g_logger = nullptr;
+std::atomic<int> g_log_level(STDSC_DEFAULT_LOG_LEVEL);
 std::mutex Logger::Impl::mutex_;
 
 } /* namespace stdsc */
@@ -18,30 +18,111 @@
 #ifndef STDSC_LOG_HPP
 #define STDSC_LOG_HPP
 
+#include <cstdint>
+#include <atomic>
 #include <memory>
+#include <string>
 #include <stdsc/stdsc_define.hpp>
+#include <stdsc/stdsc_log_binary.hpp>
+#include <stdsc/stdsc_log_limiter.hpp>
 
 #define STDSC_INIT_LOG() stdsc::g_logger = stdsc::Logger::get_instance();
 
+/**
+ * The most verbose level compiled in, as the value of LogLevel_t.
+ * The macros of the more verbose levels expand to nothing, and their
+ * arguments are not evaluated. e.g. -DSTDSC_LOG_MIN_LEVEL=2 keeps ERR, WARN
+ * and INFO.
+ */
+#ifndef STDSC_LOG_MIN_LEVEL
+#define STDSC_LOG_MIN_LEVEL 4
+#endif
+
+#define STDSC_LOG_DISCARD() \
+    do                      \
+    {                       \
+    } while (0)
+
 #define STDSC_LOG_ERR(format, ...) \
     STDSC_LOG(stdsc::kLogLevelErr, format, ##__VA_ARGS__)
+
+#if STDSC_LOG_MIN_LEVEL >= 1
 #define STDSC_LOG_WARN(format, ...) \
     STDSC_LOG(stdsc::kLogLevelWarn, format, ##__VA_ARGS__)
+#else
+#define STDSC_LOG_WARN(format, ...) STDSC_LOG_DISCARD()
+#endif
+
+#if STDSC_LOG_MIN_LEVEL >= 2
 #define STDSC_LOG_INFO(format, ...) \
     STDSC_LOG(stdsc::kLogLevelInfo, format, ##__VA_ARGS__)
+#else
+#define STDSC_LOG_INFO(format, ...) STDSC_LOG_DISCARD()
+#endif
+
+#if STDSC_LOG_MIN_LEVEL >= 3
 #define STDSC_LOG_TRACE(format, ...) \
     STDSC_LOG(stdsc::kLogLevelTrace, format, ##__VA_ARGS__)
+#else
+#define STDSC_LOG_TRACE(format, ...) STDSC_LOG_DISCARD()
+#endif
+
+#if STDSC_LOG_MIN_LEVEL >= 4
 #define STDSC_LOG_DEBUG(format, ...) \
     STDSC_LOG(stdsc::kLogLevelDebug, format, ##__VA_ARGS__)
+#else
+#define STDSC_LOG_DEBUG(format, ...) STDSC_LOG_DISCARD()
+#endif
 
-#define STDSC_LOG(level, format, ...)                                        \
-    do                                                                       \
-    {                                                                        \
-        if (nullptr != stdsc::g_logger)                                      \
-        {                                                                    \
-            stdsc::g_logger->emit((level), __FILE__, __FUNCTION__, __LINE__, \
-                                  format, ##__VA_ARGS__);                    \
-        }                                                                    \
+/*
+ * The level is checked inline, so the disabled messages cost a load.
+ * The format must be a string literal, since the site keeps the first
+ * pointer for the binary mode ("" fails to compile otherwise).
+ */
+#define STDSC_LOG(level, format, ...)                                      \
+    do                                                                     \
+    {                                                                      \
+        if (stdsc::log_enabled(level))                                     \
+        {                                                                  \
+            static const stdsc::LogSite stdsc_log_site_(                   \
+              (level), __FILE__, __FUNCTION__, __LINE__, "" format);       \
+            stdsc::g_logger->log(stdsc_log_site_, "" format,               \
+                                 ##__VA_ARGS__);                           \
+        }                                                                  \
+    } while (0)
+
+/**
+ * Rate-limited and sampled logging. Each call site has its own limiter:
+ * STDSC_LOG_RATE logs at most rate messages per second with bursts of
+ * burst messages, and STDSC_LOG_EVERY_N logs the first and every n-th
+ * message. The number of suppressed messages is logged with the next
+ * message of the site. The level must be a constant.
+ */
+#define STDSC_LOG_RATE(level, rate, burst, format, ...)                 \
+    STDSC_LOG_LIMITED(level, stdsc::LogRateLimiter, ((rate), (burst)), \
+                      format, ##__VA_ARGS__)
+
+#define STDSC_LOG_EVERY_N(level, n, format, ...)                         \
+    STDSC_LOG_LIMITED(level, stdsc::LogSampler, ((n)), format, ##__VA_ARGS__)
+
+#define STDSC_LOG_LIMITED(level, limiter_type, limiter_args, format, ...)   \
+    do                                                                     \
+    {                                                                      \
+        if ((level) <= STDSC_LOG_MIN_LEVEL && stdsc::log_enabled(level))   \
+        {                                                                  \
+            static limiter_type stdsc_log_limiter_ limiter_args;           \
+            uint64_t stdsc_log_suppressed_ = 0;                            \
+            if (stdsc_log_limiter_.allow(stdsc_log_suppressed_))           \
+            {                                                              \
+                if (stdsc_log_suppressed_ != 0)                            \
+                {                                                          \
+                    STDSC_LOG(level, "(suppressed %llu messages)",         \
+                              static_cast<unsigned long long>(             \
+                                stdsc_log_suppressed_));                   \
+                }                                                          \
+                STDSC_LOG(level, format, ##__VA_ARGS__);                   \
+            }                                                              \
+        }                                                                  \
     } while (0)
 
 #define STDSC_SET_LOG_LEVEL(level)               \
@@ -69,8 +150,24 @@ enum LogLevel_t : int
     kLogLevelNum,
 };
 
+/**
+ * @brief Enumeration for behavior of asynchronous logging when the buffer
+ * of the thread is full.
+ */
+enum LogOverflowPolicy_t : int
+{
+    kLogOverflowDrop = 0,  ///< drops the message and counts it
+    kLogOverflowBlock = 1, ///< waits until the writer makes room
+};
+
 /**
  * @brief Provides logging function.
+ * By default, messages are written to stdout on the calling thread.
+ * In asynchronous mode, each thread formats messages into its own
+ * lock-free ring buffer, and a background thread writes them in batches.
+ * In binary mode, the messages are not formatted: the ID of the call site
+ * and the raw arguments are written, and stdsc_logdecode formats them
+ * offline.
  */
 class Logger
 {
@@ -90,15 +187,90 @@ public:
               const char* func_name, int source_line_number, const char* format,
               ...) const;
 
+    /**
+     * Logs the message of the call site, formatted now or in binary mode
+     * later. The format is the one of the call site; the binary mode
+     * decodes with the format recorded in the site.
+     */
+    template <class... Args>
+    void log(const LogSite& site, const char* format,
+             const Args&... args) const
+    {
+        if (binary_.load(std::memory_order_relaxed))
+        {
+            LogArgWriter writer;
+            writer.put_all(args...);
+            emit_binary(site, writer.data(), writer.size());
+            return;
+        }
+        emit(static_cast<LogLevel_t>(site.level), site.file, site.func,
+             site.line, format, args...);
+    }
+
     void set_level(const LogLevel_t level);
 
+    /**
+     * Switches to asynchronous mode. Messages are written to the file, or
+     * to stdout if filepath is empty. Messages longer than a ring entry
+     * are truncated. This must not be called while other threads log.
+     * @param[in] ring_size number of messages buffered per thread
+     *                      (rounded up to a power of two)
+     */
+    void enable_async(const std::string& filepath = "",
+                      const std::size_t ring_size = STDSC_LOG_RING_SIZE,
+                      const LogOverflowPolicy_t policy = kLogOverflowDrop);
+
+    /**
+     * Writes the buffered messages and switches back to synchronous mode.
+     * This must not be called while other threads log.
+     */
+    void disable_async(void);
+
+    /**
+     * Switches to binary mode, which is asynchronous mode writing the binary
+     * log to the file. This must not be called while other threads log.
+     */
+    void enable_binary(const std::string& filepath,
+                       const std::size_t ring_size = STDSC_LOG_RING_SIZE,
+                       const LogOverflowPolicy_t policy = kLogOverflowDrop);
+
+    bool is_binary(void) const;
+
+    bool is_async(void) const;
+
+    /**
+     * Waits until the messages logged before the call are written.
+     */
+    void flush(void) const;
+
+    /**
+     * Returns the number of messages dropped in asynchronous mode.
+     */
+    uint64_t dropped_count(void) const;
+
 private:
+    void emit_binary(const LogSite& site, const void* args,
+                     const std::size_t size) const;
+
+    std::atomic<bool> binary_;
+
     struct Impl;
     std::shared_ptr<Impl> pimpl_;
 };
 
 extern Logger* g_logger;
 
+/**
+ * The current level of g_logger, mirrored for the inline check.
+ */
+extern std::atomic<int> g_log_level;
+
+inline bool log_enabled(const LogLevel_t level)
+{
+    return level <= g_log_level.load(std::memory_order_relaxed) &&
+           nullptr != g_logger;
+}
+
 } /* namespace stdsc */
 
 #endif /* STDSC_LOG_HPP */
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_LOG_BINARY_HPP
+#define STDSC_LOG_BINARY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+/* size of the arguments of a message in binary logging */
+#define STDSC_LOG_ARGS_SIZE (448)
+
+namespace stdsc
+{
+
+/*
+ * Binary log file:
+ *   header  : u32 magic, u16 version, u16 reserved
+ *   frames  : u8 type followed by
+ *     site    : u32 id, u32 level, u32 line, then file, function and format
+ *               as u16 length and bytes
+ *     message : u32 site id, u8 debuginfo, u64 time (ns since epoch),
+ *               u16 size, arguments
+ *     text    : u16 size, formatted line
+ *   argument: u8 type followed by i64, u64, f64, u64 (pointer), or
+ *             u16 length and bytes (string)
+ * All integers are in host byte order.
+ */
+static constexpr uint32_t STDSC_LOG_BINARY_MAGIC = 0x474C4453; /* "SDLG" */
+static constexpr uint16_t STDSC_LOG_BINARY_VERSION = 1;
+
+/**
+ * @brief Enumeration for frame types of binary log.
+ */
+enum LogFrame_t : uint8_t
+{
+    kLogFrameSite = 1,
+    kLogFrameMessage = 2,
+    kLogFrameText = 3,
+};
+
+/**
+ * @brief Enumeration for argument types of binary log.
+ */
+enum LogArg_t : uint8_t
+{
+    kLogArgSigned = 'i',
+    kLogArgUnsigned = 'u',
+    kLogArgDouble = 'd',
+    kLogArgString = 's',
+    kLogArgPointer = 'p',
+};
+
+/**
+ * @brief Call site of the logging macros.
+ * Each site is registered at its first message and gets a sequential ID.
+ * The format must be a string literal.
+ */
+struct LogSite
+{
+    LogSite(const int level, const char* file, const char* func,
+            const int line, const char* format);
+
+    /**
+     * Returns the site of the ID, or nullptr.
+     */
+    static const LogSite* find(const uint32_t id);
+
+    uint32_t id;
+    int level;
+    const char* file;
+    const char* func;
+    int line;
+    const char* format;
+};
+
+/**
+ * @brief Encodes the arguments of a message. The strings are truncated to
+ * fit, and the arguments which do not fit are dropped.
+ */
+class LogArgWriter
+{
+public:
+    LogArgWriter(void) : size_(0)
+    {
+    }
+
+    void put_all(void)
+    {
+    }
+
+    template <class T, class... Rest>
+    void put_all(const T& v, const Rest&... rest)
+    {
+        put(v);
+        put_all(rest...);
+    }
+
+    template <class T>
+    typename std::enable_if<(std::is_integral<T>::value &&
+                             std::is_signed<T>::value) ||
+                            std::is_enum<T>::value>::type
+    put(const T v)
+    {
+        put_value(kLogArgSigned, static_cast<int64_t>(v));
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_signed<T>::value>::type
+    put(const T v)
+    {
+        put_value(kLogArgUnsigned, static_cast<uint64_t>(v));
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    put(const T v)
+    {
+        put_value(kLogArgDouble, static_cast<double>(v));
+    }
+
+    template <class T>
+    void put(const T* p)
+    {
+        put_value(kLogArgPointer,
+                  static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p)));
+    }
+
+    void put(const char* s)
+    {
+        put_string(s ? s : "(null)", s ? std::strlen(s) : 6);
+    }
+
+    void put(const std::string& s)
+    {
+        put_string(s.data(), s.size());
+    }
+
+    const uint8_t* data(void) const
+    {
+        return buf_;
+    }
+
+    std::size_t size(void) const
+    {
+        return size_;
+    }
+
+private:
+    template <class T>
+    void put_value(const LogArg_t type, const T v)
+    {
+        if (sizeof(buf_) - size_ < 1 + sizeof(T))
+        {
+            return;
+        }
+        buf_[size_++] = type;
+        std::memcpy(buf_ + size_, &v, sizeof(T));
+        size_ += sizeof(T);
+    }
+
+    void put_string(const char* s, std::size_t len)
+    {
+        const std::size_t head = 1 + sizeof(uint16_t);
+        if (sizeof(buf_) - size_ < head)
+        {
+            return;
+        }
+        len = std::min(len, sizeof(buf_) - size_ - head);
+        uint16_t n = static_cast<uint16_t>(len);
+        buf_[size_++] = kLogArgString;
+        std::memcpy(buf_ + size_, &n, sizeof(n));
+        size_ += sizeof(n);
+        std::memcpy(buf_ + size_, s, len);
+        size_ += len;
+    }
+
+    uint8_t buf_[STDSC_LOG_ARGS_SIZE];
+    std::size_t size_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_LOG_BINARY_HPP */
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_LOG_LIMITER_HPP
+#define STDSC_LOG_LIMITER_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace stdsc
+{
+
+/**
+ * @brief Token bucket of a call site: allows rate messages per second on
+ * average and bursts of burst messages. This is lock-free, and a suppressed
+ * message costs a clock read and an atomic increment.
+ */
+class LogRateLimiter
+{
+public:
+    LogRateLimiter(const double rate, const double burst)
+      : interval_(static_cast<int64_t>(1e9 / rate)),
+        tolerance_(
+          static_cast<int64_t>(1e9 / rate * (std::max(burst, 1.0) - 1))),
+        tat_(0),
+        suppressed_(0)
+    {
+    }
+
+    /**
+     * Returns true if the message may be logged.
+     * @param[out] suppressed number of messages suppressed since the last
+     *                        allowed message
+     */
+    bool allow(uint64_t& suppressed)
+    {
+        const int64_t now =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+
+        /* the theoretical arrival time of the next message moves forward by
+         * the interval per allowed message */
+        int64_t tat = tat_.load(std::memory_order_relaxed);
+        do
+        {
+            if (now < tat - tolerance_)
+            {
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!tat_.compare_exchange_weak(tat,
+                                             std::max(tat, now) + interval_,
+                                             std::memory_order_relaxed));
+
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    const int64_t interval_;
+    const int64_t tolerance_;
+    std::atomic<int64_t> tat_;
+    std::atomic<uint64_t> suppressed_;
+};
+
+/**
+ * @brief Allows the first and then every n-th message of a call site.
+ */
+class LogSampler
+{
+public:
+    explicit LogSampler(const uint64_t n)
+      : n_(std::max<uint64_t>(n, 1)), count_(0)
+    {
+    }
+
+    /**
+     * Returns true if the message may be logged.
+     * @param[out] suppressed number of messages suppressed since the last
+     *                        allowed message
+     */
+    bool allow(uint64_t& suppressed)
+    {
+        const uint64_t count = count_.fetch_add(1, std::memory_order_relaxed);
+        if (count % n_ != 0)
+        {
+            return false;
+        }
+        suppressed = (count == 0) ? 0 : n_ - 1;
+        return true;
+    }
+
+private:
+    const uint64_t n_;
+    std::atomic<uint64_t> count_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_LOG_LIMITER_HPP */
@@ -15,6 +15,7 @@
  * limitations under the License.
  */
 
+#include <cstring>
 #include <sstream>
 
 #include <stdsc/stdsc_packet.hpp>
@@ -55,4 +56,19 @@ Packet make_packet(uint64_t control_code)
     return make_enum_field_packet(control_code, 0);
 }
 
+uint64_t get_request_id(const Packet& packet)
+{
+    uint64_t request_id;
+    std::memcpy(&request_id,
+                &packet.u_body.padding[STDSC_PACKET_REQUEST_ID_OFFSET],
+                sizeof(request_id));
+    return request_id;
+}
+
+void set_request_id(Packet& packet, uint64_t request_id)
+{
+    std::memcpy(&packet.u_body.padding[STDSC_PACKET_REQUEST_ID_OFFSET],
+                &request_id, sizeof(request_id));
+}
+
 } /* namespace stdsc_packet */
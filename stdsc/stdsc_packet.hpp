@@ -25,7 +25,12 @@ namespace stdsc
 {
 
 static const uint32_t STDSC_PACKET_BODY_SIZE = 1024;
-static const uint32_t STDSC_FIXED_STRING_SIZE = 1024;
+
+/* The last 8 bytes of the body carry the request ID of tracing (0: none).
+ * None of the bodies reach them, so the fixed string stops before. */
+static const uint32_t STDSC_PACKET_REQUEST_ID_OFFSET =
+  STDSC_PACKET_BODY_SIZE - sizeof(uint64_t);
+static const uint32_t STDSC_FIXED_STRING_SIZE = STDSC_PACKET_REQUEST_ID_OFFSET;
 
 /**
  * @brief Enumeration for control code of packet.
@@ -42,6 +47,8 @@ enum ControlCode_t : uint64_t
     kControlCodeFailed          = 0x0103,
     kControlCodeConnected       = 0x0104,
     kControlCodeDisConnected    = 0x0105,
+    kControlCodeStatistics      = 0x0106, ///< download of server statistics
+    kControlCodeFlightRecords   = 0x0107, ///< download of flight records
 
     /* Code for Request packet: 0x0200-0x02FF */
     kControlCodeGroupRequest    = 0x0200,
@@ -79,6 +86,11 @@ union Body
     EnumFieldBody enum_field;
 };
 
+static_assert(sizeof(FixedStringBody) <= STDSC_PACKET_REQUEST_ID_OFFSET &&
+                sizeof(DataHeader) <= STDSC_PACKET_REQUEST_ID_OFFSET &&
+                sizeof(EnumFieldBody) <= STDSC_PACKET_REQUEST_ID_OFFSET,
+              "The bodies overlap the request ID.");
+
 /**
  * @brief This class is used to hold the packet data.
  */
@@ -96,6 +108,8 @@ Packet make_data_packet(uint64_t control_code, uint64_t size);
 Packet make_fixed_string_packet(const std::string string_);
 Packet make_fixed_string_packet(int32_t val);
 Packet make_packet(uint64_t control_code);
+uint64_t get_request_id(const Packet& packet);
+void set_request_id(Packet& packet, uint64_t request_id);
 
 template <class T>
 static Packet make_enum_field_packet(uint64_t control_code, T enum_val)
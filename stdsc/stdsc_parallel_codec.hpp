@@ -0,0 +1,466 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_PARALLEL_CODEC_HPP
+#define STDSC_PARALLEL_CODEC_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <stdsc/stdsc_define.hpp>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_binary_codec.hpp>
+#include <stdsc/stdsc_compute_pool.hpp>
+#include <stdsc/stdsc_streambuf.hpp>
+
+namespace stdsc
+{
+
+static constexpr uint32_t STDSC_PARALLEL_MAGIC = 0x4E424450; /* "PDBN" */
+static constexpr uint16_t STDSC_PARALLEL_VERSION = 1;
+
+/**
+ * @brief Header of the parallel format of data.
+ * The segment table and the segments follow the header.
+ */
+struct ParallelHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t element_size; ///< 0 if the elements have variable length
+    uint64_t count;
+    uint64_t segment_count;
+};
+
+/**
+ * @brief Entry of the segment table of the parallel format.
+ */
+struct ParallelSegment
+{
+    uint64_t index;
+    uint64_t first; ///< index of the first element in the segment
+    uint64_t count; ///< number of elements in the segment
+    uint64_t size;  ///< size of the segment in bytes
+};
+
+/**
+ * @brief Provides the parallel format of a vector of elements.
+ * The vector is partitioned into segments which are encoded and decoded
+ * concurrently. The trivially copyable elements are copied in bulk, the
+ * others are encoded with BinaryElementCodec.
+ */
+template <class T>
+struct ParallelCodec
+{
+    using is_bulk = typename BinaryCodec<T>::is_bulk;
+
+    /**
+     * Returns true if the stream starts with the parallel header.
+     */
+    static bool is_parallel(std::istream& is)
+    {
+        const auto magic = STDSC_PARALLEL_MAGIC;
+        auto c = is.peek();
+        return c != std::char_traits<char>::eof() &&
+               static_cast<char>(c) == *reinterpret_cast<const char*>(&magic);
+    }
+
+    /**
+     * Returns true if the reader is at the parallel header.
+     */
+    static bool is_parallel(const BufferReader& reader)
+    {
+        const auto magic = STDSC_PARALLEL_MAGIC;
+        return sizeof(magic) <= reader.remaining() &&
+               std::memcmp(reader.peek(sizeof(magic)), &magic,
+                           sizeof(magic)) == 0;
+    }
+
+    /**
+     * Returns the size of the data saved by save().
+     * It is calculated without serialization if the elements are trivially
+     * copyable. The others are counted segment by segment in parallel,
+     * without keeping the encoded data.
+     */
+    static std::size_t stream_size(const std::vector<T>& vec)
+    {
+        auto segments = partition(vec.size());
+        measure(vec, segments, is_bulk());
+        return table_size(segments) + payload_size(segments);
+    }
+
+    /**
+     * Writes the data to the stream. The segments of the elements which are
+     * not trivially copyable are encoded in parallel, but the stream itself
+     * is written sequentially.
+     */
+    static void save(std::ostream& os, const std::vector<T>& vec)
+    {
+        auto segments = partition(vec.size());
+        std::vector<std::string> payloads;
+        encode(vec, segments, payloads, is_bulk());
+
+        auto header = make_header(vec.size(), segments.size());
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os.write(reinterpret_cast<const char*>(segments.data()),
+                 segments.size() * sizeof(ParallelSegment));
+        for (std::size_t i = 0; i < segments.size(); ++i)
+        {
+            os.write(segment_data(vec, segments[i], payloads, i),
+                     segments[i].size);
+        }
+    }
+
+    static void save(BufferWriter& writer, const std::vector<T>& vec)
+    {
+        auto segments = partition(vec.size());
+        std::vector<std::string> payloads;
+        encode(vec, segments, payloads, is_bulk());
+
+        writer.reserve(table_size(segments) + payload_size(segments));
+        writer.put(make_header(vec.size(), segments.size()));
+        writer.write(segments.data(), segments.size() * sizeof(ParallelSegment));
+        auto* dst = static_cast<char*>(writer.claim(payload_size(segments)));
+        auto offsets = segment_offsets(segments);
+        for_each_segment(segments, [&](std::size_t i) {
+            std::memcpy(dst + offsets[i],
+                        segment_data(vec, segments[i], payloads, i),
+                        segments[i].size);
+        });
+    }
+
+    static void load(std::istream& is, std::vector<T>& vec)
+    {
+        ParallelHeader header;
+        is.read(reinterpret_cast<char*>(&header), sizeof(header));
+        STDSC_THROW_FAILURE_IF_CHECK(is.good(), "Failed to read header.");
+        check_header(header);
+        STDSC_THROW_FAILURE_IF_CHECK(
+          header.segment_count == 0 || header.segment_count - 1 <= header.count,
+          "Invalid segment count.");
+
+        /* The table and the payload are read as they arrive, so that a
+         * corrupt header fails at the end of the stream instead of being
+         * allocated at once. */
+        std::vector<ParallelSegment> segments;
+        for (uint64_t i = 0; i < header.segment_count; ++i)
+        {
+            ParallelSegment seg;
+            is.read(reinterpret_cast<char*>(&seg), sizeof(seg));
+            STDSC_THROW_FAILURE_IF_CHECK(is.good(),
+                                         "Failed to read segment table.");
+            segments.push_back(seg);
+        }
+        check_segments(header, segments);
+
+        load_payload(is, segments, vec, is_bulk());
+    }
+
+    static void load(BufferReader& reader, std::vector<T>& vec)
+    {
+        auto header = reader.get<ParallelHeader>();
+        check_header(header);
+        STDSC_THROW_FAILURE_IF_CHECK(
+          header.segment_count <= reader.remaining() / sizeof(ParallelSegment),
+          "Invalid segment count.");
+
+        std::vector<ParallelSegment> segments(header.segment_count);
+        reader.read(segments.data(), segments.size() * sizeof(ParallelSegment));
+        const auto size = check_segments(header, segments);
+        STDSC_THROW_FAILURE_IF_CHECK(size <= reader.remaining(),
+                                     "Failed to read segments.");
+
+        decode(reader.get_slice(static_cast<std::size_t>(size)), segments,
+               vec, is_bulk());
+    }
+
+private:
+    template <class Func>
+    static void for_each_segment(const std::vector<ParallelSegment>& segments,
+                                 Func func)
+    {
+        ComputePool::instance().parallel_for(
+          0, segments.size(), [&](std::size_t first, std::size_t last) {
+              for (auto i = first; i < last; ++i)
+              {
+                  func(i);
+              }
+          });
+    }
+
+    static ParallelHeader make_header(const uint64_t count,
+                                      const uint64_t segment_count)
+    {
+        ParallelHeader header;
+        header.magic = STDSC_PARALLEL_MAGIC;
+        header.version = STDSC_PARALLEL_VERSION;
+        header.element_size = BinaryCodec<T>::element_size();
+        header.count = count;
+        header.segment_count = segment_count;
+        return header;
+    }
+
+    static void check_header(const ParallelHeader& header)
+    {
+        STDSC_THROW_FAILURE_IF_CHECK(header.magic == STDSC_PARALLEL_MAGIC,
+                                     "Invalid parallel format.");
+        STDSC_THROW_FAILURE_IF_CHECK(header.version == STDSC_PARALLEL_VERSION,
+                                     "Unsupported parallel format version.");
+        STDSC_THROW_FAILURE_IF_CHECK(
+          header.element_size == BinaryCodec<T>::element_size(),
+          "Mismatched element size.");
+    }
+
+    /**
+     * Checks that the segments cover the elements in order, and returns the
+     * size of the payload. The sizes are checked without overflow.
+     */
+    static uint64_t check_segments(const ParallelHeader& header,
+                                   const std::vector<ParallelSegment>& segments)
+    {
+        uint64_t first = 0;
+        uint64_t size = 0;
+        for (std::size_t i = 0; i < segments.size(); ++i)
+        {
+            const auto& seg = segments[i];
+            STDSC_THROW_FAILURE_IF_CHECK(
+              seg.index == i && seg.first == first &&
+                seg.count <= header.count - first,
+              "Invalid segment table.");
+            STDSC_THROW_FAILURE_IF_CHECK(
+              !is_bulk::value || (seg.size % sizeof(T) == 0 &&
+                                  seg.size / sizeof(T) == seg.count),
+              "Invalid segment size.");
+            STDSC_THROW_FAILURE_IF_CHECK(
+              seg.size <= std::numeric_limits<std::size_t>::max() - size,
+              "Invalid segment size.");
+            first += seg.count;
+            size += seg.size;
+        }
+        STDSC_THROW_FAILURE_IF_CHECK(first == header.count,
+                                     "Invalid segment table.");
+        return size;
+    }
+
+    static std::vector<ParallelSegment> partition(const std::size_t count)
+    {
+        std::size_t nsegs = ComputePool::instance().size();
+        nsegs = std::min(nsegs, count / STDSC_PARALLEL_SEGMENT_MIN_COUNT);
+        nsegs = std::max<std::size_t>(1, nsegs);
+
+        std::vector<ParallelSegment> segments(nsegs);
+        std::size_t first = 0;
+        for (std::size_t i = 0; i < nsegs; ++i)
+        {
+            auto& seg = segments[i];
+            seg.index = i;
+            seg.first = first;
+            seg.count = count / nsegs + (i < count % nsegs ? 1 : 0);
+            seg.size = seg.count * sizeof(T);
+            first += seg.count;
+        }
+        return segments;
+    }
+
+    static std::size_t table_size(const std::vector<ParallelSegment>& segments)
+    {
+        return sizeof(ParallelHeader) +
+               segments.size() * sizeof(ParallelSegment);
+    }
+
+    static std::size_t payload_size(const std::vector<ParallelSegment>& segments)
+    {
+        std::size_t size = 0;
+        for (const auto& seg : segments)
+        {
+            size += seg.size;
+        }
+        return size;
+    }
+
+    static std::vector<std::size_t> segment_offsets(
+      const std::vector<ParallelSegment>& segments)
+    {
+        std::vector<std::size_t> offsets(segments.size());
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < segments.size(); ++i)
+        {
+            offsets[i] = offset;
+            offset += segments[i].size;
+        }
+        return offsets;
+    }
+
+    static const char* segment_data(const std::vector<T>& vec,
+                                    const ParallelSegment& seg,
+                                    const std::vector<std::string>& payloads,
+                                    const std::size_t i)
+    {
+        return is_bulk::value
+                 ? reinterpret_cast<const char*>(vec.data() + seg.first)
+                 : payloads[i].data();
+    }
+
+    static void measure(const std::vector<T>&, std::vector<ParallelSegment>&,
+                        std::true_type)
+    {
+    }
+
+    static void measure(const std::vector<T>& vec,
+                        std::vector<ParallelSegment>& segments, std::false_type)
+    {
+        for_each_segment(segments, [&](std::size_t i) {
+            auto& seg = segments[i];
+            CountingStreamBuf counter;
+            std::ostream os(&counter);
+            for (uint64_t j = 0; j < seg.count; ++j)
+            {
+                BinaryElementCodec<T>::save(os, vec[seg.first + j]);
+            }
+            seg.size = counter.count();
+        });
+    }
+
+    static void encode(const std::vector<T>&, std::vector<ParallelSegment>&,
+                       std::vector<std::string>&, std::true_type)
+    {
+    }
+
+    static void encode(const std::vector<T>& vec,
+                       std::vector<ParallelSegment>& segments,
+                       std::vector<std::string>& payloads, std::false_type)
+    {
+        payloads.resize(segments.size());
+        for_each_segment(segments, [&](std::size_t i) {
+            auto& seg = segments[i];
+            std::ostringstream oss;
+            for (uint64_t j = 0; j < seg.count; ++j)
+            {
+                BinaryElementCodec<T>::save(oss, vec[seg.first + j]);
+            }
+            payloads[i] = oss.str();
+            seg.size = payloads[i].size();
+        });
+    }
+
+    /* The elements are read in chunks into the vector, which grows as
+     * they arrive. */
+    static void load_payload(std::istream& is,
+                             const std::vector<ParallelSegment>& segments,
+                             std::vector<T>& vec, std::true_type)
+    {
+        const uint64_t count = segments.empty()
+                                 ? 0
+                                 : segments.back().first + segments.back().count;
+        const uint64_t chunk =
+          std::max<uint64_t>(1, STDSC_STREAM_CHUNK_SIZE / sizeof(T));
+        vec.clear();
+        while (vec.size() < count)
+        {
+            const auto pos = vec.size();
+            const auto n =
+              static_cast<std::size_t>(std::min<uint64_t>(count - pos, chunk));
+            vec.resize(pos + n);
+            const auto bytes = static_cast<std::streamsize>(n * sizeof(T));
+            is.read(reinterpret_cast<char*>(vec.data() + pos), bytes);
+            STDSC_THROW_FAILURE_IF_CHECK(is.gcount() == bytes,
+                                         "Failed to read segments.");
+        }
+    }
+
+    /* The payload buffer doubles as the data arrives, and is decoded once
+     * it is complete. */
+    static void load_payload(std::istream& is,
+                             const std::vector<ParallelSegment>& segments,
+                             std::vector<T>& vec, std::false_type)
+    {
+        const auto size = static_cast<std::size_t>(payload_size(segments));
+        Buffer payload(0);
+        std::size_t pos = 0;
+        while (pos < size)
+        {
+            const auto n = std::min(
+              size, std::max<std::size_t>(STDSC_STREAM_CHUNK_SIZE, pos * 2));
+            payload.resize(n);
+            const auto bytes = static_cast<std::streamsize>(n - pos);
+            is.read(static_cast<char*>(payload.data()) + pos, bytes);
+            STDSC_THROW_FAILURE_IF_CHECK(is.gcount() == bytes,
+                                         "Failed to read segments.");
+            pos = n;
+        }
+        decode(payload, segments, vec, is_bulk());
+    }
+
+    static void decode(const Buffer& payload,
+                       const std::vector<ParallelSegment>& segments,
+                       std::vector<T>& vec, std::true_type)
+    {
+        auto offsets = segment_offsets(segments);
+        vec.resize(static_cast<std::size_t>(payload.size() / sizeof(T)));
+        for_each_segment(segments, [&](std::size_t i) {
+            const auto& seg = segments[i];
+            std::memcpy(vec.data() + seg.first,
+                        static_cast<const uint8_t*>(payload.data()) + offsets[i],
+                        seg.size);
+        });
+    }
+
+    /* Each segment is decoded into its own vector, so that the count in the
+     * table is not trusted for allocation, and then moved into `vec`. The
+     * elements must use up the segment exactly. */
+    static void decode(const Buffer& payload,
+                       const std::vector<ParallelSegment>& segments,
+                       std::vector<T>& vec, std::false_type)
+    {
+        auto offsets = segment_offsets(segments);
+        std::vector<std::vector<T>> parts(segments.size());
+        for_each_segment(segments, [&](std::size_t i) {
+            const auto& seg = segments[i];
+            BufferStream bs(payload.slice(offsets[i], seg.size));
+            std::istream is(&bs);
+            for (uint64_t j = 0; j < seg.count; ++j)
+            {
+                T v;
+                BinaryElementCodec<T>::load(is, v);
+                parts[i].push_back(std::move(v));
+            }
+            STDSC_THROW_FAILURE_IF_CHECK(is.peek() ==
+                                           std::char_traits<char>::eof(),
+                                         "Invalid segment size.");
+        });
+
+        vec.clear();
+        vec.reserve(static_cast<std::size_t>(
+          segments.empty() ? 0 : segments.back().first + segments.back().count));
+        for (auto& part : parts)
+        {
+            std::move(part.begin(), part.end(), std::back_inserter(vec));
+        }
+    }
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_PARALLEL_CODEC_HPP */
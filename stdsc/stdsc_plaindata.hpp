@@ -20,45 +20,117 @@
 
 #include <memory>
 #include <stdsc/stdsc_basicdata.hpp>
+#include <stdsc/stdsc_binary_codec.hpp>
+#include <stdsc/stdsc_text_codec.hpp>
+#include <stdsc/stdsc_parallel_codec.hpp>
 
 namespace stdsc
 {
 
+/**
+ * @brief Enumeration for serialization format of plain data.
+ */
+enum PlainDataFormat_t : int32_t
+{
+    kPlainDataFormatText   = 0,
+    kPlainDataFormatBinary = 1,
+    kPlainDataFormatParallel = 2,
+};
+
 /**
  * @brief This clas is used to hold the plain data.
+ * The data is saved in the format specified at construction (text by
+ * default, which the peers of any version can read), and is loaded from
+ * any format.
  */
 template <class T>
 struct PlainData : public stdsc::BasicData<T>
 {
     using super = stdsc::BasicData<T>;
     
-    PlainData() = default;
+    PlainData(const PlainDataFormat_t format = kPlainDataFormatText)
+      : format_(format)
+    {
+    }
     virtual ~PlainData(void) = default;
 
+    void set_format(const PlainDataFormat_t format)
+    {
+        format_ = format;
+    }
+
+    PlainDataFormat_t format(void) const
+    {
+        return format_;
+    }
+
     virtual void save_to_stream(std::ostream& os) const override
     {
-        if (super::vec_.size() == 0) {
+        if (format_ == kPlainDataFormatBinary) {
+            BinaryCodec<T>::save(os, super::vec_);
             return;
         }
-        
-        os << super::vec_.size() << std::endl;
-        for (const auto& v : super::vec_) {
-            os << v << std::endl;
+        if (format_ == kPlainDataFormatParallel) {
+            ParallelCodec<T>::save(os, super::vec_);
+            return;
         }
+
+        TextCodec<T>::save(os, super::vec_);
     }        
     virtual void load_from_stream(std::istream& is) override
     {
-        size_t sz;
-        is >> sz;
-    
-        super::clear();
-        
-        for (size_t i=0; i<sz; ++i) {
-            T v;
-            is >> v;
-            super::vec_.push_back(v);
+        if (BinaryCodec<T>::is_binary(is)) {
+            BinaryCodec<T>::load(is, super::vec_);
+            return;
+        }
+        if (ParallelCodec<T>::is_parallel(is)) {
+            ParallelCodec<T>::load(is, super::vec_);
+            return;
+        }
+
+        TextCodec<T>::load(is, super::vec_);
+    }
+
+    virtual size_t stream_size(void) const override
+    {
+        if (format_ == kPlainDataFormatBinary) {
+            return BinaryCodec<T>::stream_size(super::vec_);
+        }
+        if (format_ == kPlainDataFormatParallel) {
+            return ParallelCodec<T>::stream_size(super::vec_);
+        }
+        /* the text format is serialized to be counted */
+        return super::stream_size();
+    }
+
+    virtual void save_to_buffer(BufferWriter& writer) const override
+    {
+        if (format_ == kPlainDataFormatBinary) {
+            BinaryCodec<T>::save(writer, super::vec_);
+            return;
         }
+        if (format_ == kPlainDataFormatParallel) {
+            ParallelCodec<T>::save(writer, super::vec_);
+            return;
+        }
+        super::save_to_buffer(writer);
+    }
+
+    virtual void load_from_buffer(BufferReader& reader) override
+    {
+        if (BinaryCodec<T>::is_binary(reader)) {
+            BinaryCodec<T>::load(reader, super::vec_);
+            return;
+        }
+        if (ParallelCodec<T>::is_parallel(reader)) {
+            ParallelCodec<T>::load(reader, super::vec_);
+            return;
+        }
+        super::load_from_buffer(reader);
     }
+
+private:
+    PlainDataFormat_t format_;
 };
 
 } /* namespace stdsc */
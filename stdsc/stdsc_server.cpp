@@ -16,8 +16,10 @@
  */
 
 #include <unistd.h>
+#include <cstring>
 #include <memory>
 #include <limits>
+#include <sstream>
 #include <vector>
 #include <stdsc/stdsc_server.hpp>
 #include <stdsc/stdsc_socket.hpp>
@@ -26,7 +28,12 @@
 #include <stdsc/stdsc_packet.hpp>
 #include <stdsc/stdsc_callback_function_container.hpp>
 #include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
 #include <stdsc/stdsc_state.hpp>
+#include <stdsc/stdsc_stats.hpp>
+#include <stdsc/stdsc_stats_segment.hpp>
+#include <stdsc/stdsc_trace.hpp>
+#include <stdsc/stdsc_flight_recorder.hpp>
 
 namespace stdsc
 {
@@ -46,11 +53,12 @@ struct Server<T>::Impl
     {
         ResourceContainer(Socket& sock,
                           StateContext& state,
-                          CallbackFunctionContainer& callback)
+                          CallbackFunctionContainer& callback,
+                          const std::shared_ptr<ServerStats>& stats)
             : sock_(sock),
               state_(state),        // copy
               callback_(callback),  // ref
-              th_(new ServerThread<>(sock_, state_, callback)),
+              th_(new ServerThread<>(sock_, state_, callback, stats)),
               is_released_(false)
         {}
 
@@ -98,6 +106,9 @@ struct Server<T>::Impl
          StateContext& state,
          CallbackFunctionContainer& callback)
         : param_(),
+          zerocopy_enabled_(false),
+          zerocopy_threshold_(0),
+          stats_(new ServerStats()),
           port_(port),
           state_(state),       // copy
           callback_(callback)  // copy
@@ -118,9 +129,13 @@ struct Server<T>::Impl
             try
             {
                 Socket sock = Socket::accept_connection(listen_socket);
+                if (zerocopy_enabled_)
+                {
+                    sock.enable_zerocopy(zerocopy_threshold_);
+                }
                 
                 std::shared_ptr<ResourceContainer>
-                    rc(new ResourceContainer(sock, state_, callback_));
+                    rc(new ResourceContainer(sock, state_, callback_, stats_));
                 rc->invoke();
                 
                 resources.push_back(std::move(rc));
@@ -141,8 +156,19 @@ struct Server<T>::Impl
 public:
     std::shared_ptr<ThreadException> te_;
     ServerParam param_;
+    bool zerocopy_enabled_;
+    std::size_t zerocopy_threshold_;
+    std::shared_ptr<ServerStats> stats_;
+
+    void enable_stats_segment(const uint32_t interval_msec)
+    {
+        publisher_.reset();
+        publisher_ = std::make_shared<StatsPublisher>(port_, stats_,
+                                                      interval_msec);
+    }
     
 private:
+    std::shared_ptr<StatsPublisher> publisher_;
     const char* port_;
     StateContext state_;
     CallbackFunctionContainer callback_;
@@ -185,6 +211,25 @@ void Server<T>::wait(void)
     pimpl_->te_->rethrow_if_has_exception();
 }
 
+template <class T>
+void Server<T>::enable_zerocopy(const std::size_t threshold)
+{
+    pimpl_->zerocopy_enabled_ = true;
+    pimpl_->zerocopy_threshold_ = threshold;
+}
+
+template <class T>
+std::shared_ptr<ServerStats> Server<T>::stats(void) const
+{
+    return pimpl_->stats_;
+}
+
+template <class T>
+void Server<T>::enable_stats_segment(const uint32_t interval_msec)
+{
+    pimpl_->enable_stats_segment(interval_msec);
+}
+
 template <class T>
 void Server<T>::exec(T& args, std::shared_ptr<ThreadException> te) const
 {
@@ -202,48 +247,192 @@ struct ServerThread<T>::Impl
 {
     Impl(Socket& sock,
          StateContext& state,
-         CallbackFunctionContainer& callback)
+         CallbackFunctionContainer& callback,
+         const std::shared_ptr<ServerStats>& stats)
         : param_(),
           sock_(sock),
-          state_(state),      // ref
-          callback_(callback) // ref
+          state_(state),       // ref
+          callback_(callback), // ref
+          stats_(stats)
     {
         te_ = ThreadException::create();
     }
 
     void exec(T& args, std::shared_ptr<ThreadException> te)
     {
+        /* counts the connection as active while the thread runs */
+        std::shared_ptr<ServerStats::Recorder> recorder;
+        if (stats_)
+        {
+            recorder = stats_->make_recorder();
+        }
+        const SocketCounters& counters = sock_.counters();
+        FlightRecorder flight(sock_.connection_id());
+
         while (!args.force_finish)
         {
+            const uint64_t received = counters.bytes_received;
+            const uint64_t sent = counters.bytes_sent;
+            RequestTiming timing{};
+            Packet packet;
             try
             {
-                Packet packet;
+                bool rejected = false;
+                const bool traced = trace_enabled();
+
                 sock_.recv_packet(packet);
-                STDSC_LOG_TRACE("Received packet. (code:0x%08x)",
-                                packet.control_code);
+                timing.ready = counters.ready_ns;
+                timing.header = RequestTiming::now();
+                timing.payload = timing.header;
+                timing.callback = timing.header;
+                STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                               STDSC_LOG_RATE_BURST,
+                               "Received packet. (code:0x%08x)",
+                               packet.control_code);
 
                 try
                 {
-                    callback_.eval(sock_, packet, state_);
-                    STDSC_LOG_TRACE("callback finished.");
-                    sock_.send_packet(make_packet(kControlCodeAccept));
+                    if (packet.control_code == kControlCodeStatistics)
+                    {
+                        send_stats();
+                    }
+                    else if (packet.control_code == kControlCodeFlightRecords)
+                    {
+                        send_flight_records();
+                    }
+                    else
+                    {
+                        callback_.eval(sock_, packet, state_,
+                                       (recorder || traced) ? &timing
+                                                            : nullptr);
+                        flush_zerocopy();
+                        STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                                       STDSC_LOG_RATE_BURST,
+                                       "callback finished.");
+                        sock_.send_packet(make_packet(kControlCodeAccept));
+                    }
                 }
                 catch (const CallbackException& e)
                 {
-                    STDSC_LOG_TRACE(
-                        "Failed to execute callback function. %s", e.what());
+                    STDSC_LOG_RATE(kLogLevelTrace, STDSC_LOG_RATE_LIMIT,
+                                   STDSC_LOG_RATE_BURST,
+                                   "Failed to execute callback function. %s",
+                                   e.what());
+                    timing.callback = RequestTiming::now();
+                    flush_zerocopy();
                     sock_.send_packet(make_packet(kControlCodeReject));
+                    rejected = true;
+                }
+
+                timing.ack = RequestTiming::now();
+                flight.record(packet.control_code,
+                              counters.bytes_received - received,
+                              counters.bytes_sent - sent, timing.ready,
+                              timing.ack, state_.current_state(),
+                              rejected ? kRequestResultReject
+                                       : kRequestResultAccept);
+                if (recorder)
+                {
+                    recorder->record(packet.control_code, timing,
+                                     counters.bytes_received - received,
+                                     counters.bytes_sent - sent, rejected);
+                }
+                if (traced)
+                {
+                    trace(packet, timing);
                 }
             }
             catch (const stdsc::AbstractException& e)
             {
-                STDSC_LOG_ERR("Failed to server process (%s)", e.what());
+                STDSC_LOG_RATE(kLogLevelErr, STDSC_LOG_RATE_LIMIT,
+                               STDSC_LOG_RATE_BURST,
+                               "Failed to server process (%s)", e.what());
+
+                /* the client closing the connection between requests is
+                 * not worth a dump */
+                const bool in_request = packet.control_code != kControlCodeNil;
+                if (in_request || !dynamic_cast<const SocketException*>(&e))
+                {
+                    flight.record(packet.control_code,
+                                  counters.bytes_received - received,
+                                  counters.bytes_sent - sent, timing.ready,
+                                  RequestTiming::now(), state_.current_state(),
+                                  kRequestResultFailure);
+                    flight.log();
+                }
                 te->set_current_exception();
                 break;
             }
         }
     }
 
+    /* splits the request into spans keyed by the client's request id */
+    void trace(const Packet& packet, const RequestTiming& timing)
+    {
+        auto& tracer = Tracer::instance();
+        const uint64_t code = packet.control_code;
+        const uint64_t id = get_request_id(packet);
+        tracer.record("server.request", code, id, timing.ready, timing.ack);
+        tracer.record("server.recv_header", code, id, timing.ready,
+                      timing.header);
+        tracer.record("server.payload", code, id, timing.header,
+                      timing.payload);
+        tracer.record("server.callback", code, id, timing.payload,
+                      timing.callback);
+        tracer.record("server.ack", code, id, timing.callback, timing.ack);
+    }
+
+    /* The callback may reuse or free the buffers it sent once it has
+     * returned, so the pages sent by zero-copy are released by the kernel
+     * before the ack. */
+    void flush_zerocopy(void)
+    {
+        if (sock_.is_zerocopy_enabled())
+        {
+            STDSC_THROW_SOCKET_IF_CHECK(
+              sock_.flush_zerocopy(STDSC_ZEROCOPY_FLUSH_TIMEOUT_SEC),
+              "Timed out waiting for zerocopy completions.");
+        }
+    }
+
+    /* replies to kControlCodeStatistics like a download callback */
+    void send_stats(void)
+    {
+        if (!stats_)
+        {
+            sock_.send_packet(make_packet(kControlCodeReject));
+            return;
+        }
+
+        Buffer buffer;
+        BufferWriter writer(buffer);
+        stats_->snapshot().save(writer);
+        writer.finish();
+        send_reserved_data(kControlCodeStatistics, buffer);
+    }
+
+    /* replies to kControlCodeFlightRecords with the text dump */
+    void send_flight_records(void)
+    {
+        std::ostringstream oss;
+        FlightRecorder::dump_all(oss);
+        const std::string text = oss.str();
+
+        Buffer buffer(text.size());
+        std::memcpy(buffer.data(), text.data(), text.size());
+        send_reserved_data(kControlCodeFlightRecords, buffer);
+    }
+
+    void send_reserved_data(const uint64_t code, const Buffer& buffer)
+    {
+        /* make_data_packet() does not take reserved codes */
+        Packet packet(code);
+        packet.u_body.data.size = buffer.size();
+        sock_.send_packet(packet);
+        sock_.send_buffer(buffer);
+        sock_.send_packet(make_packet(kControlCodeAccept));
+    }
+
 public:
     std::shared_ptr<ThreadException> te_;
     ServerThreadParam param_;
@@ -252,13 +441,15 @@ private:
     Socket& sock_;
     StateContext& state_;
     CallbackFunctionContainer& callback_;
+    std::shared_ptr<ServerStats> stats_;
 };
 
 template <class T>
 ServerThread<T>::ServerThread(Socket& sock,
                               StateContext& state,
-                              CallbackFunctionContainer& callback)
-    : pimpl_(new Impl(sock, state, callback))
+                              CallbackFunctionContainer& callback,
+                              const std::shared_ptr<ServerStats>& stats)
+    : pimpl_(new Impl(sock, state, callback, stats))
 {
 }
 
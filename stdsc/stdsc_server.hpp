@@ -19,6 +19,7 @@
 #define STDSC_SERVER_HPP
 
 #include <memory>
+#include <stdsc/stdsc_define.hpp>
 #include <stdsc/stdsc_thread.hpp>
 
 namespace stdsc
@@ -28,6 +29,7 @@ class CallbackFunctionContainer;
 class StateContext;
 class ServerParam;
 class ServerThreadParam;
+class ServerStats;
 
 /**
  * @brief Provides server function
@@ -46,6 +48,27 @@ public:
     void start(const bool async=false);
     void stop(void);
     void wait(void);
+
+    /**
+     * Enables MSG_ZEROCOPY on the accepted connections (see
+     * Socket::enable_zerocopy). The server waits for the kernel to release
+     * the buffers sent by a callback before it sends the ack, so a callback
+     * may free or reuse them once it returns. A callback which modifies a
+     * Buffer it has already sent must call sock.flush_zerocopy() first.
+     */
+    void enable_zerocopy(const std::size_t threshold = STDSC_ZEROCOPY_THRESHOLD);
+
+    /**
+     * Returns the statistics of the requests processed by the server.
+     */
+    std::shared_ptr<ServerStats> stats(void) const;
+
+    /**
+     * Publishes the statistics into the shared memory segment named after
+     * the port (see StatsPublisher) until the server is destroyed.
+     */
+    void enable_stats_segment(const uint32_t interval_msec =
+                                STDSC_STATS_PUBLISH_INTERVAL_MSEC);
     
 private:
     virtual void exec(T& args, std::shared_ptr<ThreadException> te) const override;
@@ -71,7 +94,8 @@ class ServerThread : public Thread<T>
 public:
     ServerThread(Socket& sock,
                  StateContext& state,
-                 CallbackFunctionContainer& callback);
+                 CallbackFunctionContainer& callback,
+                 const std::shared_ptr<ServerStats>& stats = nullptr);
     virtual ~ServerThread(void);
 
     void start(void);
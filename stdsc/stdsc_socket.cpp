@@ -17,22 +17,29 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <errno.h>
 #include <netdb.h>
 #include <unistd.h> // for fcntl
 #include <fcntl.h>  // for fcntl
+#include <poll.h>
 
 #include <cstdint>
 #include <climits>
 #include <cstring>
+#include <algorithm>
+#include <deque>
+#include <vector>
 
 #include <stdsc/stdsc_socket.hpp>
 #include <stdsc/stdsc_exception.hpp>
 #include <stdsc/stdsc_log.hpp>
 #include <stdsc/stdsc_packet.hpp>
 #include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_chain.hpp>
+#include <stdsc/stdsc_stats.hpp>
 
 static constexpr int INVALID_SOCKET = -1;
 static constexpr int SOCKET_ERROR = -1;
@@ -40,11 +47,19 @@ static constexpr int SOCKET_CLOSED = 0;
 static constexpr int KEEPALIVEDELAY_SEC = 60;
 static constexpr int KEEPINTERVALTIME_SEC = 30;
 static constexpr int KEEPALIVECOUNT = 10;
+static constexpr int MAX_IOV_COUNT = 1024;
 
 #if !defined(TCP_KEEPIDLE) && defined(TCP_KEEPALIVE)
 #define TCP_KEEPIDLE TCP_KEEPALIVE
 #endif
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#include <linux/errqueue.h>
+#if defined(SO_EE_ORIGIN_ZEROCOPY)
+#define STDSC_HAS_ZEROCOPY
+#endif
+#endif
+
 #define SOCKET_IF_CHECK(cond, msg)                               \
     do                                                           \
     {                                                            \
@@ -180,9 +195,54 @@ static bool wait_read(int socket, uint32_t timeout_sec)
     return true;
 }
 
+/**
+ * @brief Holds the buffers sent by MSG_ZEROCOPY until the kernel releases them.
+ */
+struct ZeroCopyContext
+{
+    /**
+     * @brief A buffer being sent or waiting for the notifications. The ids
+     * are added as the send calls consume them, so notifications received
+     * while the buffer is still being sent are counted.
+     */
+    struct Pending
+    {
+        Pending(const Buffer& buffer, uint32_t first)
+          : buffer_(buffer), first_(first), count_(0), done_(0), sending_(true)
+        {
+        }
+
+        bool released(void) const
+        {
+            return !sending_ && done_ == count_;
+        }
+
+        Buffer buffer_;  ///< shares the storage of the sent buffer
+        uint32_t first_; ///< id of the first send call
+        uint32_t count_; ///< ids consumed by the send calls
+        uint32_t done_;  ///< ids notified
+        bool sending_;
+    };
+
+    ZeroCopyContext(void)
+      : enabled_(false), threshold_(STDSC_ZEROCOPY_THRESHOLD), next_id_(0),
+        num_copied_(0)
+    {
+    }
+
+    bool enabled_;
+    std::size_t threshold_;
+    uint32_t next_id_;     ///< id of the next zero-copy send call
+    uint64_t num_copied_;  ///< number of sends the kernel fell back to copy
+    std::deque<Pending> pending_;
+};
+
 struct Socket::Impl
 {
-    Impl() : socket_(INVALID_SOCKET)
+    Impl()
+      : socket_(INVALID_SOCKET),
+        zc_(new ZeroCopyContext()),
+        counters_(new SocketCounters())
     {
     }
     ~Impl()
@@ -200,6 +260,7 @@ struct Socket::Impl
             int ret = ::recv(socket_, ptr, remain, 0);
             SOCKET_IF_CHECK(SOCKET_ERROR != ret, "Failed to receive");
             SOCKET_IF_CHECK(SOCKET_CLOSED != ret, "Socket closed");
+            counters_->bytes_received += ret;
             ptr += ret;
             remain -= ret;
         }
@@ -215,13 +276,229 @@ struct Socket::Impl
         {
             int ret = ::send(socket_, static_cast<const char*>(ptr), remain, 0);
             SOCKET_IF_CHECK(SOCKET_ERROR != ret, "Failed to send");
+            counters_->bytes_sent += ret;
+
+            ptr += ret;
+            remain -= ret;
+        }
+    }
+
+    void writev(std::vector<iovec>& iov) const
+    {
+        STDSC_LOG_DEBUG("writev : 0x%x", socket_);
+        iovec* ptr = iov.data();
+        std::size_t remain = iov.size();
+
+        while (0 < remain)
+        {
+            int count = static_cast<int>(std::min<std::size_t>(remain, MAX_IOV_COUNT));
+            ssize_t ret = ::writev(socket_, ptr, count);
+            SOCKET_IF_CHECK(SOCKET_ERROR != ret, "Failed to send");
+            counters_->bytes_sent += ret;
+
+            /* skip the vectors which have been sent completely */
+            std::size_t written = static_cast<std::size_t>(ret);
+            while (0 < remain && ptr->iov_len <= written)
+            {
+                written -= ptr->iov_len;
+                ++ptr;
+                --remain;
+            }
+            if (0 < remain)
+            {
+                ptr->iov_base = static_cast<char*>(ptr->iov_base) + written;
+                ptr->iov_len -= written;
+            }
+        }
+    }
+
+    bool is_zerocopy_target(std::size_t bytes) const
+    {
+        /* the small data is cheaper to copy than to pin */
+        return zc_->enabled_ && zc_->threshold_ <= bytes &&
+               STDSC_BUFFER_INLINE_SIZE < bytes;
+    }
+
+#if defined(STDSC_HAS_ZEROCOPY)
+    void write_zerocopy(const Buffer& buffer) const
+    {
+        STDSC_LOG_DEBUG("write zerocopy : 0x%x", socket_);
+        zc_->pending_.emplace_back(buffer, zc_->next_id_);
+        auto& pending = zc_->pending_.back();
+        const char* ptr = reinterpret_cast<const char*>(pending.buffer_.data());
+        std::size_t remain = pending.buffer_.size();
+
+        while (0 < remain)
+        {
+            int ret = ::send(socket_, ptr, remain, MSG_ZEROCOPY);
+            if (SOCKET_ERROR == ret && ENOBUFS == errno)
+            {
+                /* optmem limit is exceeded, so wait for the notifications,
+                 * or copy the rest if none of them is outstanding */
+                if (!wait_zerocopy_progress())
+                {
+                    write(ptr, remain);
+                    break;
+                }
+                continue;
+            }
+            SOCKET_IF_CHECK(SOCKET_ERROR != ret, "Failed to send");
 
+            /* each successful call consumes one notification id */
+            zc_->next_id_++;
+            pending.count_++;
+            counters_->bytes_sent += ret;
             ptr += ret;
             remain -= ret;
         }
+
+        pending.sending_ = false;
+        release_zerocopy();
+        reap_zerocopy();
+    }
+
+    /* Waits for at least one notification. Returns false if none of the
+     * sent ids is waiting for it. */
+    bool wait_zerocopy_progress(void) const
+    {
+        bool outstanding = false;
+        for (const auto& p : zc_->pending_)
+        {
+            outstanding |= (p.done_ < p.count_);
+        }
+        if (!outstanding)
+        {
+            return false;
+        }
+
+        pollfd pfd;
+        pfd.fd = socket_;
+        pfd.events = 0; /* POLLERR is always reported */
+        pfd.revents = 0;
+        int ret = ::poll(&pfd, 1, -1);
+        SOCKET_IF_CHECK(SOCKET_ERROR != ret || EINTR == errno,
+                        "Failed to poll");
+        reap_zerocopy();
+        return true;
+    }
+
+    /* Receives the completion notifications without blocking. */
+    void reap_zerocopy(void) const
+    {
+        while (!zc_->pending_.empty())
+        {
+            char control[CMSG_SPACE(sizeof(sock_extended_err)) + 64];
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            int ret = ::recvmsg(socket_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+            if (SOCKET_ERROR == ret)
+            {
+                SOCKET_IF_CHECK(EAGAIN == errno || EWOULDBLOCK == errno,
+                                "Failed to receive zerocopy notification");
+                break;
+            }
+
+            for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+                 cm = CMSG_NXTHDR(&msg, cm))
+            {
+                if (!((SOL_IP == cm->cmsg_level && IP_RECVERR == cm->cmsg_type) ||
+                      (SOL_IPV6 == cm->cmsg_level &&
+                       IPV6_RECVERR == cm->cmsg_type)))
+                {
+                    continue;
+                }
+
+                auto* serr = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cm));
+                if (SO_EE_ORIGIN_ZEROCOPY != serr->ee_origin)
+                {
+                    STDSC_LOG_WARN("unexpected error on errqueue : %d",
+                                   serr->ee_errno);
+                    continue;
+                }
+
+                if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                {
+                    zc_->num_copied_++;
+                }
+                complete_zerocopy(serr->ee_info, serr->ee_data);
+            }
+        }
+    }
+
+    void complete_zerocopy(uint32_t lo, uint32_t hi) const
+    {
+        STDSC_LOG_TRACE("zerocopy completed : %u - %u", lo, hi);
+        for (auto& p : zc_->pending_)
+        {
+            p.done_ += count_overlap(p.first_, p.count_, lo, hi);
+        }
+        release_zerocopy();
+    }
+
+    /*
+     * Returns the number of ids in [first, first + count) which are also in
+     * [lo, hi]. The ids are a 32-bit counter, so both ranges may wrap
+     * around: they are measured from `first`, where the pending range is
+     * [0, count) and the completed one is [a, a + len) or its part wrapped
+     * to [a - 2^32, a + len - 2^32).
+     */
+    static uint32_t count_overlap(uint32_t first, uint32_t count, uint32_t lo,
+                                  uint32_t hi)
+    {
+        const int64_t wrap = int64_t(1) << 32;
+        const int64_t a = static_cast<uint32_t>(lo - first);
+        const int64_t len = int64_t(static_cast<uint32_t>(hi - lo)) + 1;
+        auto overlap = [count](int64_t b, int64_t e) {
+            b = std::max<int64_t>(b, 0);
+            e = std::min<int64_t>(e, count);
+            return b < e ? e - b : 0;
+        };
+        return static_cast<uint32_t>(overlap(a, a + len) +
+                                     overlap(a - wrap, a + len - wrap));
+    }
+
+    /* Releases the buffers whose pages are no longer referred by kernel. */
+    void release_zerocopy(void) const
+    {
+        while (!zc_->pending_.empty() && zc_->pending_.front().released())
+        {
+            zc_->pending_.pop_front();
+        }
     }
 
+    bool wait_zerocopy(uint32_t timeout_sec) const
+    {
+        int timeout_msec = (STDSC_TIME_INFINITE == timeout_sec)
+                             ? -1
+                             : static_cast<int>(timeout_sec * 1000);
+
+        reap_zerocopy();
+        while (!zc_->pending_.empty())
+        {
+            pollfd pfd;
+            pfd.fd = socket_;
+            pfd.events = 0; /* POLLERR is always reported */
+            pfd.revents = 0;
+
+            int ret = ::poll(&pfd, 1, timeout_msec);
+            SOCKET_IF_CHECK(SOCKET_ERROR != ret || EINTR == errno,
+                            "Failed to poll");
+            if (0 == ret)
+            {
+                return false;
+            }
+            reap_zerocopy();
+        }
+        return true;
+    }
+#endif
+
     int socket_;
+    std::shared_ptr<ZeroCopyContext> zc_;
+    std::shared_ptr<SocketCounters> counters_;
 };
 
 Socket::Socket(void) : pimpl_(new Impl())
@@ -477,6 +754,23 @@ void Socket::shutdown(void)
 
 void Socket::close(void)
 {
+#if defined(STDSC_HAS_ZEROCOPY)
+    if (INVALID_SOCKET != pimpl_->socket_ && !pimpl_->zc_->pending_.empty())
+    {
+        try
+        {
+            if (!pimpl_->wait_zerocopy(STDSC_ZEROCOPY_FLUSH_TIMEOUT_SEC))
+            {
+                STDSC_LOG_WARN("zerocopy notifications timed out : 0x%x",
+                               pimpl_->socket_);
+            }
+        }
+        catch (const SocketException& e)
+        {
+            STDSC_LOG_WARN("Failed to flush zerocopy (%s)", e.what());
+        }
+    }
+#endif
     close_socket(pimpl_->socket_);
 }
 
@@ -493,6 +787,7 @@ void Socket::recv_packet(Packet& packet, uint32_t timeout_sec) const
 
     SOCKET_IF_CHECK(true == wait_result, "Receive timed out");
 
+    pimpl_->counters_->ready_ns = RequestTiming::now();
     pimpl_->read(reinterpret_cast<void*>(&packet), sizeof(Packet));
 }
 
@@ -500,11 +795,43 @@ void Socket::send_buffer(const Buffer& buffer) const
 {
     if (0 < buffer.size())
     {
+#if defined(STDSC_HAS_ZEROCOPY)
+        if (pimpl_->is_zerocopy_target(buffer.size()))
+        {
+            pimpl_->write_zerocopy(buffer);
+            return;
+        }
+#endif
         pimpl_->write(reinterpret_cast<const void*>(buffer.data()),
                       buffer.size());
     }
 }
 
+void Socket::send_buffer(const BufferChain& chain) const
+{
+    std::vector<iovec> iov;
+    iov.reserve(chain.count() + 1);
+
+    iovec header;
+    header.iov_base = const_cast<void*>(chain.header());
+    header.iov_len = chain.header_size();
+    iov.push_back(header);
+
+    for (std::size_t i = 0; i < chain.count(); ++i)
+    {
+        const Buffer& seg = chain.at(i);
+        if (0 < seg.size())
+        {
+            iovec v;
+            v.iov_base = const_cast<void*>(seg.data());
+            v.iov_len = seg.size();
+            iov.push_back(v);
+        }
+    }
+
+    pimpl_->writev(iov);
+}
+
 void Socket::recv_buffer(Buffer& buffer, uint32_t timeout_sec) const
 {
     if (0 < buffer.size())
@@ -517,4 +844,72 @@ void Socket::recv_buffer(Buffer& buffer, uint32_t timeout_sec) const
     }
 }
 
+void Socket::send_bytes(const void* data, std::size_t size) const
+{
+    if (0 < size)
+    {
+        pimpl_->write(data, size);
+    }
+}
+
+void Socket::recv_bytes(void* data, std::size_t size, uint32_t timeout_sec) const
+{
+    if (0 < size)
+    {
+        bool wait_result = wait_read(pimpl_->socket_, timeout_sec);
+
+        SOCKET_IF_CHECK(true == wait_result, "Receive timed out");
+
+        pimpl_->read(data, size);
+    }
+}
+
+bool Socket::enable_zerocopy(std::size_t threshold)
+{
+#if defined(STDSC_HAS_ZEROCOPY)
+    int onoff = 1;
+    int ret = setsockopt(pimpl_->socket_, SOL_SOCKET, SO_ZEROCOPY,
+                         reinterpret_cast<const char*>(&onoff), sizeof(onoff));
+    if (SOCKET_ERROR == ret)
+    {
+        STDSC_LOG_WARN("zerocopy is not supported : Sock Error Code (%d)",
+                       errno);
+        return false;
+    }
+
+    pimpl_->zc_->enabled_ = true;
+    pimpl_->zc_->threshold_ = threshold;
+    STDSC_LOG_DEBUG("enable zerocopy : 0x%x (threshold:%lu)", pimpl_->socket_,
+                    threshold);
+    return true;
+#else
+    STDSC_LOG_WARN("zerocopy is not supported on this platform");
+    return false;
+#endif
+}
+
+void Socket::disable_zerocopy(void)
+{
+    pimpl_->zc_->enabled_ = false;
+}
+
+bool Socket::is_zerocopy_enabled(void) const
+{
+    return pimpl_->zc_->enabled_;
+}
+
+bool Socket::flush_zerocopy(uint32_t timeout_sec) const
+{
+#if defined(STDSC_HAS_ZEROCOPY)
+    return pimpl_->wait_zerocopy(timeout_sec);
+#else
+    return true;
+#endif
+}
+
+const SocketCounters& Socket::counters(void) const
+{
+    return *pimpl_->counters_;
+}
+
 } /* stdsc */
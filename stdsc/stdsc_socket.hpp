@@ -32,6 +32,18 @@ namespace stdsc
 
 struct Packet;
 class Buffer;
+class BufferChain;
+
+/**
+ * @brief Traffic of a socket. The copies of a socket share the counters.
+ */
+struct SocketCounters
+{
+    uint64_t bytes_sent;     ///< bytes sent
+    uint64_t bytes_received; ///< bytes received
+    uint64_t ready_ns;       ///< time when recv_packet() found data arrived
+                             ///< (RequestTiming::now())
+};
 
 /**
  * @ brief Provices socket communication
@@ -71,9 +83,39 @@ public:
 
     void send_buffer(const Buffer& buffer) const;
 
+    void send_buffer(const BufferChain& chain) const;
+
+    void send_bytes(const void* data, std::size_t size) const;
+
+    void recv_bytes(void* data, std::size_t size,
+                    uint32_t timeout_sec = STDSC_TIME_INFINITE) const;
+
     void recv_buffer(Buffer& buffer,
                      uint32_t timeout_sec = STDSC_TIME_INFINITE) const;
 
+    /**
+     * Enables MSG_ZEROCOPY transmission for buffers of at least
+     * `threshold` bytes. Returns false if the kernel does not support it.
+     * The sent Buffer is kept alive until the kernel releases its pages,
+     * but the kernel reads them after send_buffer() returns: the caller
+     * must not modify or resize the Buffer until flush_zerocopy() returns.
+     * Resizing reallocates the shared storage, so the pages being sent are
+     * no longer the ones kept alive.
+     */
+    bool enable_zerocopy(std::size_t threshold = STDSC_ZEROCOPY_THRESHOLD);
+
+    void disable_zerocopy(void);
+
+    bool is_zerocopy_enabled(void) const;
+
+    /**
+     * Waits until the kernel has released all buffers sent by zero-copy.
+     * Returns false if timed out.
+     */
+    bool flush_zerocopy(uint32_t timeout_sec = STDSC_TIME_INFINITE) const;
+
+    const SocketCounters& counters(void) const;
+
 private:
     struct Impl;
     std::shared_ptr<Impl> pimpl_;
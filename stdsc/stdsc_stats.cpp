@@ -0,0 +1,654 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <stdsc/stdsc_define.hpp>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_stats.hpp>
+
+namespace stdsc
+{
+
+namespace
+{
+
+/* increments the counter written only by the calling thread */
+inline void bump(std::atomic<uint64_t>& counter, const uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+/**
+ * @brief Counters of a control code recorded by a thread.
+ */
+struct CodeCounters
+{
+    explicit CodeCounters(const uint64_t code) : code(code)
+    {
+        requests.store(0, std::memory_order_relaxed);
+        rejects.store(0, std::memory_order_relaxed);
+        bytes_received.store(0, std::memory_order_relaxed);
+        bytes_sent.store(0, std::memory_order_relaxed);
+        for (int phase = 0; phase < kStatsPhaseNum; ++phase)
+        {
+            sums[phase].store(0, std::memory_order_relaxed);
+            for (auto& bucket : buckets[phase])
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void load(CodeStats& stats) const
+    {
+        stats.requests += requests.load(std::memory_order_relaxed);
+        stats.rejects += rejects.load(std::memory_order_relaxed);
+        stats.bytes_received += bytes_received.load(std::memory_order_relaxed);
+        stats.bytes_sent += bytes_sent.load(std::memory_order_relaxed);
+        for (int phase = 0; phase < kStatsPhaseNum; ++phase)
+        {
+            auto& hist = stats.latency[phase];
+            hist.add_sum(sums[phase].load(std::memory_order_relaxed));
+            for (std::size_t i = 0; i < LatencyHistogram::kNumBuckets; ++i)
+            {
+                hist.add_bucket(i,
+                                buckets[phase][i].load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    const uint64_t code;
+    std::atomic<uint64_t> requests;
+    std::atomic<uint64_t> rejects;
+    std::atomic<uint64_t> bytes_received;
+    std::atomic<uint64_t> bytes_sent;
+    std::atomic<uint64_t> sums[kStatsPhaseNum];
+    std::atomic<uint64_t> buckets[kStatsPhaseNum][LatencyHistogram::kNumBuckets];
+};
+
+using CodeStatsMap = std::map<uint64_t, CodeStats>;
+
+/* version of the binary form of StatsSnapshot */
+constexpr uint64_t STATS_FORMAT_VERSION = 1;
+
+} /* namespace */
+
+//
+// RequestTiming
+//
+
+uint64_t RequestTiming::now(void)
+{
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count());
+}
+
+//
+// LatencyHistogram
+//
+
+constexpr std::size_t LatencyHistogram::kSubBucketBits;
+constexpr std::size_t LatencyHistogram::kSubBuckets;
+constexpr std::size_t LatencyHistogram::kMaxBits;
+constexpr std::size_t LatencyHistogram::kNumBuckets;
+
+LatencyHistogram::LatencyHistogram(void) : count_(0), sum_(0)
+{
+    buckets_.fill(0);
+}
+
+std::size_t LatencyHistogram::bucket_of(const uint64_t ns)
+{
+    if (ns < kSubBuckets)
+    {
+        return static_cast<std::size_t>(ns);
+    }
+    const std::size_t msb = 63 - __builtin_clzll(ns);
+    if (kMaxBits <= msb)
+    {
+        return kNumBuckets - 1;
+    }
+    const std::size_t shift = msb - kSubBucketBits;
+    return (msb - kSubBucketBits + 1) * kSubBuckets +
+           static_cast<std::size_t>((ns >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::bucket_upper(const std::size_t index)
+{
+    if (index < kSubBuckets)
+    {
+        return index;
+    }
+    const std::size_t shift = index / kSubBuckets - 1;
+    const uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::add(const uint64_t ns)
+{
+    add_bucket(bucket_of(ns), 1);
+    add_sum(ns);
+}
+
+void LatencyHistogram::add_bucket(const std::size_t index, const uint64_t count)
+{
+    buckets_[std::min(index, kNumBuckets - 1)] += count;
+    count_ += count;
+}
+
+void LatencyHistogram::add_sum(const uint64_t sum)
+{
+    sum_ += sum;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& rhs)
+{
+    for (std::size_t i = 0; i < kNumBuckets; ++i)
+    {
+        buckets_[i] += rhs.buckets_[i];
+    }
+    count_ += rhs.count_;
+    sum_ += rhs.sum_;
+}
+
+void LatencyHistogram::subtract(const LatencyHistogram& rhs)
+{
+    for (std::size_t i = 0; i < kNumBuckets; ++i)
+    {
+        buckets_[i] -= std::min(buckets_[i], rhs.buckets_[i]);
+    }
+    count_ -= std::min(count_, rhs.count_);
+    sum_ -= std::min(sum_, rhs.sum_);
+}
+
+uint64_t LatencyHistogram::count(void) const
+{
+    return count_;
+}
+
+uint64_t LatencyHistogram::sum(void) const
+{
+    return sum_;
+}
+
+uint64_t LatencyHistogram::bucket(const std::size_t index) const
+{
+    return buckets_[index];
+}
+
+uint64_t LatencyHistogram::percentile(const double p) const
+{
+    if (0 == count_)
+    {
+        return 0;
+    }
+    const double rank = std::max(1.0, std::min(p, 100.0) / 100.0 * count_);
+    uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < kNumBuckets; ++i)
+    {
+        cumulative += buckets_[i];
+        if (rank <= cumulative)
+        {
+            return bucket_upper(i);
+        }
+    }
+    return bucket_upper(kNumBuckets - 1);
+}
+
+//
+// CodeStats
+//
+
+CodeStats::CodeStats(const uint64_t code)
+  : code(code), requests(0), rejects(0), bytes_received(0), bytes_sent(0)
+{
+}
+
+void CodeStats::merge(const CodeStats& rhs)
+{
+    requests += rhs.requests;
+    rejects += rhs.rejects;
+    bytes_received += rhs.bytes_received;
+    bytes_sent += rhs.bytes_sent;
+    for (int phase = 0; phase < kStatsPhaseNum; ++phase)
+    {
+        latency[phase].merge(rhs.latency[phase]);
+    }
+}
+
+void CodeStats::subtract(const CodeStats& rhs)
+{
+    requests -= std::min(requests, rhs.requests);
+    rejects -= std::min(rejects, rhs.rejects);
+    bytes_received -= std::min(bytes_received, rhs.bytes_received);
+    bytes_sent -= std::min(bytes_sent, rhs.bytes_sent);
+    for (int phase = 0; phase < kStatsPhaseNum; ++phase)
+    {
+        latency[phase].subtract(rhs.latency[phase]);
+    }
+}
+
+//
+// StatsSnapshot
+//
+
+void StatsSnapshot::save(BufferWriter& writer) const
+{
+    writer.put_varint(STATS_FORMAT_VERSION);
+    writer.put_varint(connections);
+    writer.put_varint(active_connections);
+    writer.put_varint(elapsed_ns);
+    writer.put_varint(codes.size());
+    for (const auto& stats : codes)
+    {
+        writer.put_varint(stats.code);
+        writer.put_varint(stats.requests);
+        writer.put_varint(stats.rejects);
+        writer.put_varint(stats.bytes_received);
+        writer.put_varint(stats.bytes_sent);
+        for (const auto& hist : stats.latency)
+        {
+            std::size_t used = 0;
+            for (std::size_t i = 0; i < LatencyHistogram::kNumBuckets; ++i)
+            {
+                used += (0 < hist.bucket(i));
+            }
+            writer.put_varint(hist.sum());
+            writer.put_varint(used);
+
+            /* pairs of the distance from the previous bucket and count */
+            std::size_t prev = 0;
+            for (std::size_t i = 0; i < LatencyHistogram::kNumBuckets; ++i)
+            {
+                if (0 < hist.bucket(i))
+                {
+                    writer.put_varint(i - prev);
+                    writer.put_varint(hist.bucket(i));
+                    prev = i;
+                }
+            }
+        }
+    }
+}
+
+void StatsSnapshot::load(BufferReader& reader)
+{
+    const uint64_t version = reader.get_varint();
+    STDSC_THROW_FAILURE_IF_CHECK(version == STATS_FORMAT_VERSION,
+                                 "Unsupported statistics format.");
+    connections = reader.get_varint();
+    active_connections = reader.get_varint();
+    elapsed_ns = reader.get_varint();
+
+    const uint64_t count = reader.get_varint();
+    codes.clear();
+    for (uint64_t n = 0; n < count; ++n)
+    {
+        CodeStats stats(reader.get_varint());
+        stats.requests = reader.get_varint();
+        stats.rejects = reader.get_varint();
+        stats.bytes_received = reader.get_varint();
+        stats.bytes_sent = reader.get_varint();
+        for (auto& hist : stats.latency)
+        {
+            hist.add_sum(reader.get_varint());
+            const uint64_t used = reader.get_varint();
+            std::size_t index = 0;
+            for (uint64_t i = 0; i < used; ++i)
+            {
+                index += reader.get_varint();
+                STDSC_THROW_FAILURE_IF_CHECK(
+                  index < LatencyHistogram::kNumBuckets,
+                  "Broken statistics.");
+                hist.add_bucket(index, reader.get_varint());
+            }
+        }
+        codes.push_back(stats);
+    }
+}
+
+//
+// ServerStats
+//
+
+struct ServerStats::Recorder::Impl
+{
+    explicit Impl(const std::shared_ptr<ServerStats::Impl>& owner)
+      : owner_(owner), size_(0), last_(nullptr)
+    {
+        for (auto& slot : slots_)
+        {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~Impl(void)
+    {
+        for (auto& slot : slots_)
+        {
+            delete slot.load(std::memory_order_relaxed);
+        }
+    }
+
+    /* Codes over the table size share the last slot as code 0. */
+    CodeCounters& find(const uint64_t code)
+    {
+        if (last_ && last_->code == code)
+        {
+            return *last_;
+        }
+        const std::size_t size = size_.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            auto* counters = slots_[i].load(std::memory_order_relaxed);
+            if (counters->code == code)
+            {
+                last_ = counters;
+                return *counters;
+            }
+        }
+        if (size == STDSC_STATS_MAX_CODES)
+        {
+            last_ = slots_[size - 1].load(std::memory_order_relaxed);
+            return *last_;
+        }
+
+        const uint64_t key = (size + 1 == STDSC_STATS_MAX_CODES) ? 0 : code;
+        last_ = new CodeCounters(key);
+        slots_[size].store(last_, std::memory_order_release);
+        size_.store(size + 1, std::memory_order_release);
+        return *last_;
+    }
+
+    void load(CodeStatsMap& codes) const
+    {
+        const std::size_t size = size_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto* counters = slots_[i].load(std::memory_order_acquire);
+            auto it = codes.find(counters->code);
+            if (it == codes.end())
+            {
+                it = codes.emplace(counters->code, CodeStats(counters->code))
+                       .first;
+            }
+            counters->load(it->second);
+        }
+    }
+
+    std::shared_ptr<ServerStats::Impl> owner_;
+    std::atomic<CodeCounters*> slots_[STDSC_STATS_MAX_CODES];
+    std::atomic<std::size_t> size_;
+    CodeCounters* last_;
+};
+
+struct ServerStats::Impl
+{
+    Impl(void)
+      : connections_(0),
+        base_connections_(0),
+        created_(RequestTiming::now()),
+        start_(created_)
+    {
+    }
+
+    /* sums the counters of the live and finished connections */
+    void load(CodeStatsMap& codes) const
+    {
+        codes = retired_;
+        for (const auto* recorder : recorders_)
+        {
+            recorder->load(codes);
+        }
+    }
+
+    StatsSnapshot snapshot(const bool since_reset)
+    {
+        CodeStatsMap codes;
+        StatsSnapshot snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            load(codes);
+            if (since_reset)
+            {
+                for (const auto& kv : base_)
+                {
+                    auto it = codes.find(kv.first);
+                    if (it != codes.end())
+                    {
+                        it->second.subtract(kv.second);
+                    }
+                }
+            }
+            const uint64_t now = RequestTiming::now();
+            snapshot.connections =
+              connections_ - (since_reset ? base_connections_ : 0);
+            snapshot.active_connections = recorders_.size();
+            snapshot.elapsed_ns = now - (since_reset ? start_ : created_);
+        }
+
+        snapshot.codes.reserve(codes.size());
+        for (auto& kv : codes)
+        {
+            snapshot.codes.push_back(kv.second);
+        }
+        return snapshot;
+    }
+
+    std::mutex mutex_;
+    std::vector<const Recorder::Impl*> recorders_;
+    CodeStatsMap retired_; ///< counters of the finished connections
+    CodeStatsMap base_;    ///< counters at the last reset
+    uint64_t connections_;
+    uint64_t base_connections_;
+    uint64_t created_;
+    uint64_t start_; ///< time of the last reset
+};
+
+ServerStats::Recorder::Recorder(const std::shared_ptr<Impl>& pimpl)
+  : pimpl_(pimpl)
+{
+}
+
+ServerStats::Recorder::~Recorder(void)
+{
+    auto& owner = *pimpl_->owner_;
+    std::lock_guard<std::mutex> lock(owner.mutex_);
+    pimpl_->load(owner.retired_);
+    auto& recorders = owner.recorders_;
+    recorders.erase(std::remove(recorders.begin(), recorders.end(),
+                                pimpl_.get()),
+                    recorders.end());
+}
+
+void ServerStats::Recorder::record(const uint64_t code,
+                                   const RequestTiming& timing,
+                                   const uint64_t bytes_received,
+                                   const uint64_t bytes_sent,
+                                   const bool rejected)
+{
+    CodeCounters& counters = pimpl_->find(code);
+    bump(counters.requests, 1);
+    if (rejected)
+    {
+        bump(counters.rejects, 1);
+    }
+    bump(counters.bytes_received, bytes_received);
+    bump(counters.bytes_sent, bytes_sent);
+
+    const uint64_t points[kStatsPhaseNum + 1] = {
+      timing.ready, timing.header, timing.payload, timing.callback, timing.ack};
+    for (int phase = 0; phase < kStatsPhaseNum; ++phase)
+    {
+        const uint64_t ns = (points[phase] < points[phase + 1])
+                              ? points[phase + 1] - points[phase]
+                              : 0;
+        bump(counters.buckets[phase][LatencyHistogram::bucket_of(ns)], 1);
+        bump(counters.sums[phase], ns);
+    }
+}
+
+ServerStats::ServerStats(void) : pimpl_(new Impl())
+{
+}
+
+std::shared_ptr<ServerStats::Recorder> ServerStats::make_recorder(void)
+{
+    std::shared_ptr<Recorder::Impl> impl(new Recorder::Impl(pimpl_));
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    pimpl_->recorders_.push_back(impl.get());
+    ++pimpl_->connections_;
+    return std::shared_ptr<Recorder>(new Recorder(impl));
+}
+
+StatsSnapshot ServerStats::snapshot(void) const
+{
+    return pimpl_->snapshot(true);
+}
+
+StatsSnapshot ServerStats::totals(void) const
+{
+    return pimpl_->snapshot(false);
+}
+
+void ServerStats::reset(void)
+{
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    pimpl_->load(pimpl_->base_);
+    pimpl_->base_connections_ = pimpl_->connections_;
+    pimpl_->start_ = RequestTiming::now();
+}
+
+//
+// ClientStats
+//
+
+ClientCodeStats::ClientCodeStats(const uint64_t code)
+  : code(code),
+    requests(0),
+    rejects(0),
+    failures(0),
+    retries(0),
+    retry_sleep_ns(0),
+    bytes_sent(0),
+    bytes_received(0)
+{
+}
+
+ClientStatsSnapshot::ClientStatsSnapshot(void)
+  : connects(0), connect_failures(0), connect_retries(0), elapsed_ns(0)
+{
+}
+
+struct ClientStats::Impl
+{
+    Impl(void) : start_(RequestTiming::now())
+    {
+    }
+
+    ClientCodeStats& find(const uint64_t code)
+    {
+        auto it = codes_.find(code);
+        if (it == codes_.end())
+        {
+            it = codes_.emplace(code, ClientCodeStats(code)).first;
+        }
+        return it->second;
+    }
+
+    mutable std::mutex mutex_;
+    std::map<uint64_t, ClientCodeStats> codes_;
+    ClientStatsSnapshot connection_; ///< counters of connect() only
+    uint64_t start_;                 ///< time of the last reset
+};
+
+ClientStats::ClientStats(void) : pimpl_(new Impl())
+{
+}
+
+void ClientStats::record(const uint64_t code, const uint64_t latency_ns,
+                         const uint64_t bytes_sent,
+                         const uint64_t bytes_received,
+                         const RequestResult_t result)
+{
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    auto& stats = pimpl_->find(code);
+    ++stats.requests;
+    stats.rejects += (result == kRequestResultReject);
+    stats.failures += (result == kRequestResultFailure);
+    stats.bytes_sent += bytes_sent;
+    stats.bytes_received += bytes_received;
+    stats.latency.add(latency_ns);
+}
+
+void ClientStats::record_retry(const uint64_t code, const uint64_t sleep_ns)
+{
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    auto& stats = pimpl_->find(code);
+    ++stats.retries;
+    stats.retry_sleep_ns += sleep_ns;
+}
+
+void ClientStats::record_blocking(const uint64_t code,
+                                  const uint64_t latency_ns)
+{
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    pimpl_->find(code).blocking_latency.add(latency_ns);
+}
+
+void ClientStats::record_connect(const uint64_t latency_ns,
+                                 const uint64_t retries, const bool connected)
+{
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    auto& connection = pimpl_->connection_;
+    connection.connects += connected;
+    connection.connect_failures += !connected;
+    connection.connect_retries += retries;
+    connection.connect_latency.add(latency_ns);
+}
+
+ClientStatsSnapshot ClientStats::snapshot(void) const
+{
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    ClientStatsSnapshot snapshot = pimpl_->connection_;
+    snapshot.elapsed_ns = RequestTiming::now() - pimpl_->start_;
+    snapshot.codes.reserve(pimpl_->codes_.size());
+    for (const auto& kv : pimpl_->codes_)
+    {
+        snapshot.codes.push_back(kv.second);
+    }
+    return snapshot;
+}
+
+void ClientStats::reset(void)
+{
+    std::lock_guard<std::mutex> lock(pimpl_->mutex_);
+    pimpl_->codes_.clear();
+    pimpl_->connection_ = ClientStatsSnapshot();
+    pimpl_->start_ = RequestTiming::now();
+}
+
+} /* namespace stdsc */
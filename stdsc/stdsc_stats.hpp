@@ -0,0 +1,269 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_STATS_HPP
+#define STDSC_STATS_HPP
+
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace stdsc
+{
+
+class BufferWriter;
+class BufferReader;
+
+/**
+ * @brief Enumeration for phases of a request processed by the server.
+ */
+enum StatsPhase_t : int
+{
+    kStatsPhaseHeader = 0,   ///< receiving the packet after data arrives
+    kStatsPhasePayload = 1,  ///< receiving the payload
+    kStatsPhaseCallback = 2, ///< executing the callback function
+    kStatsPhaseAck = 3,      ///< sending accept or reject
+    kStatsPhaseNum,
+};
+
+/**
+ * @brief Time points of a request in nanoseconds of the steady clock.
+ * Each phase ends at the time point of the next one.
+ */
+struct RequestTiming
+{
+    uint64_t ready;    ///< data of the packet arrived
+    uint64_t header;   ///< packet received
+    uint64_t payload;  ///< payload received
+    uint64_t callback; ///< callback function finished
+    uint64_t ack;      ///< accept or reject sent
+
+    static uint64_t now(void);
+};
+
+/**
+ * @brief Log-linear histogram of latencies in nanoseconds.
+ * Each power of two is split into 16 buckets, so the relative error of
+ * percentiles is at most 1/16. Latencies longer than 2^40 ns are counted in
+ * the last bucket.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr std::size_t kSubBucketBits = 4;
+    static constexpr std::size_t kSubBuckets = 1 << kSubBucketBits;
+    static constexpr std::size_t kMaxBits = 40;
+    static constexpr std::size_t kNumBuckets =
+      (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram(void);
+
+    static std::size_t bucket_of(const uint64_t ns);
+
+    /**
+     * Returns the largest latency counted in the bucket.
+     */
+    static uint64_t bucket_upper(const std::size_t index);
+
+    void add(const uint64_t ns);
+    void add_bucket(const std::size_t index, const uint64_t count);
+    void add_sum(const uint64_t sum);
+    void merge(const LatencyHistogram& rhs);
+    void subtract(const LatencyHistogram& rhs);
+
+    uint64_t count(void) const;
+    uint64_t sum(void) const;
+    uint64_t bucket(const std::size_t index) const;
+
+    /**
+     * Returns the upper bound of the latency at the percentile (0-100).
+     */
+    uint64_t percentile(const double p) const;
+
+private:
+    std::array<uint64_t, kNumBuckets> buckets_;
+    uint64_t count_;
+    uint64_t sum_;
+};
+
+/**
+ * @brief Statistics of a control code.
+ */
+struct CodeStats
+{
+    CodeStats(const uint64_t code = 0);
+
+    uint64_t code;           ///< control code (0: codes over the table size)
+    uint64_t requests;       ///< processed requests
+    uint64_t rejects;        ///< requests answered with reject
+    uint64_t bytes_received; ///< bytes received including packets
+    uint64_t bytes_sent;     ///< bytes sent including acks
+    LatencyHistogram latency[kStatsPhaseNum];
+
+    void merge(const CodeStats& rhs);
+    void subtract(const CodeStats& rhs);
+};
+
+/**
+ * @brief Statistics of a server since the last reset.
+ */
+struct StatsSnapshot
+{
+    uint64_t connections;        ///< accepted connections
+    uint64_t active_connections; ///< connections being served
+    uint64_t elapsed_ns;         ///< time since the last reset
+    std::vector<CodeStats> codes; ///< ordered by control code
+
+    /**
+     * Writes the snapshot in the compact binary form, in which the
+     * histograms keep only the buckets counted.
+     */
+    void save(BufferWriter& writer) const;
+    void load(BufferReader& reader);
+};
+
+/**
+ * @brief Collects the statistics of requests processed by a server.
+ * Each connection thread records into its own counters without locks, and
+ * snapshot() sums them up. reset() keeps the current values as the base of
+ * the following snapshots, so it does not disturb the recording threads.
+ */
+class ServerStats
+{
+public:
+    /**
+     * @brief Counters of a thread. This must be used by one thread.
+     */
+    class Recorder
+    {
+    public:
+        ~Recorder(void);
+
+        void record(const uint64_t code, const RequestTiming& timing,
+                    const uint64_t bytes_received, const uint64_t bytes_sent,
+                    const bool rejected);
+
+    private:
+        friend class ServerStats;
+        struct Impl;
+        explicit Recorder(const std::shared_ptr<Impl>& pimpl);
+        std::shared_ptr<Impl> pimpl_;
+    };
+
+    ServerStats(void);
+    ~ServerStats(void) = default;
+
+    ServerStats(const ServerStats&) = delete;
+    ServerStats& operator=(const ServerStats&) = delete;
+
+    /**
+     * Returns the counters for a new connection.
+     */
+    std::shared_ptr<Recorder> make_recorder(void);
+
+    StatsSnapshot snapshot(void) const;
+
+    /**
+     * Returns the statistics since the creation, regardless of reset().
+     */
+    StatsSnapshot totals(void) const;
+
+    void reset(void);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+/**
+ * @brief Enumeration for results of a request sent by a client.
+ */
+enum RequestResult_t : int
+{
+    kRequestResultAccept = 0, ///< answered with accept
+    kRequestResultReject = 1, ///< answered with reject
+    kRequestResultFailure = 2, ///< failed or broken on the socket
+};
+
+/**
+ * @brief Statistics of a control code requested by a client.
+ */
+struct ClientCodeStats
+{
+    ClientCodeStats(const uint64_t code = 0);
+
+    uint64_t code;           ///< control code
+    uint64_t requests;       ///< attempts including rejected and failed ones
+    uint64_t rejects;        ///< attempts answered with reject
+    uint64_t failures;       ///< attempts failed on the socket
+    uint64_t retries;        ///< retries of the blocking functions
+    uint64_t retry_sleep_ns; ///< time slept before the retries
+    uint64_t bytes_sent;     ///< bytes sent including packets
+    uint64_t bytes_received; ///< bytes received including acks
+    LatencyHistogram latency;          ///< from the request to the ack
+    LatencyHistogram blocking_latency; ///< blocking functions with retries
+};
+
+/**
+ * @brief Statistics of a client since the last reset.
+ */
+struct ClientStatsSnapshot
+{
+    ClientStatsSnapshot(void);
+
+    uint64_t connects;                ///< established connections
+    uint64_t connect_failures;        ///< connections timed out
+    uint64_t connect_retries;         ///< retries of the connections
+    LatencyHistogram connect_latency; ///< connect() with retries
+    uint64_t elapsed_ns;              ///< time since the last reset
+    std::vector<ClientCodeStats> codes; ///< ordered by control code
+};
+
+/**
+ * @brief Collects the statistics of requests sent by a client.
+ * Comparing `latency` with `retry_sleep_ns` and `blocking_latency` tells
+ * whether the calls wait for the network or for the server to accept them.
+ */
+class ClientStats
+{
+public:
+    ClientStats(void);
+    ~ClientStats(void) = default;
+
+    ClientStats(const ClientStats&) = delete;
+    ClientStats& operator=(const ClientStats&) = delete;
+
+    void record(const uint64_t code, const uint64_t latency_ns,
+                const uint64_t bytes_sent, const uint64_t bytes_received,
+                const RequestResult_t result);
+    void record_retry(const uint64_t code, const uint64_t sleep_ns);
+    void record_blocking(const uint64_t code, const uint64_t latency_ns);
+    void record_connect(const uint64_t latency_ns, const uint64_t retries,
+                        const bool connected);
+
+    ClientStatsSnapshot snapshot(void) const;
+    void reset(void);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_STATS_HPP */
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_stats.hpp>
+#include <stdsc/stdsc_stats_segment.hpp>
+
+namespace stdsc
+{
+
+namespace
+{
+
+constexpr uint32_t SEGMENT_MAGIC = 0x54535453; /* "STST" */
+constexpr uint32_t SEGMENT_VERSION = 1;
+
+/**
+ * @brief Layout of the segment. The sequence is odd while the data is
+ * being written.
+ */
+struct SegmentLayout
+{
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint64_t> sequence;
+    StatsSegmentData data;
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "The sequence must be lock-free to be shared by processes.");
+
+void fill(StatsSegmentData& data, const StatsSnapshot& snapshot)
+{
+    std::memset(&data, 0, sizeof(data));
+    data.pid = static_cast<uint64_t>(getpid());
+    data.update_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch())
+        .count());
+    data.elapsed_ns = snapshot.elapsed_ns;
+    data.connections = snapshot.connections;
+    data.active_connections = snapshot.active_connections;
+
+    for (const auto& stats : snapshot.codes)
+    {
+        if (STDSC_STATS_MAX_CODES <= data.num_codes)
+        {
+            break;
+        }
+        auto& code = data.codes[data.num_codes++];
+        code.code = stats.code;
+        code.requests = stats.requests;
+        code.rejects = stats.rejects;
+        code.bytes_received = stats.bytes_received;
+        code.bytes_sent = stats.bytes_sent;
+        for (const auto& hist : stats.latency)
+        {
+            code.busy_ns += hist.sum();
+        }
+        const auto& callback = stats.latency[kStatsPhaseCallback];
+        code.callback_ns = callback.sum();
+        code.callback_p50_ns = callback.percentile(50);
+        code.callback_p99_ns = callback.percentile(99);
+    }
+}
+
+} /* namespace */
+
+//
+// StatsPublisher
+//
+
+struct StatsPublisher::Impl
+{
+    Impl(const char* port, const std::shared_ptr<ServerStats>& stats,
+         const uint32_t interval_msec)
+      : name_(segment_name(port)),
+        stats_(stats),
+        interval_(interval_msec),
+        layout_(nullptr),
+        stop_(false)
+    {
+        int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+        STDSC_THROW_FILE_IF_CHECK(0 <= fd, "Failed to open shared memory. (" +
+                                             name_ + ")");
+        int ret = ftruncate(fd, sizeof(SegmentLayout));
+        void* addr = (0 == ret)
+                       ? mmap(nullptr, sizeof(SegmentLayout),
+                              PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                       : MAP_FAILED;
+        close(fd);
+        if (MAP_FAILED == addr)
+        {
+            shm_unlink(name_.c_str());
+            STDSC_THROW_FILE("Failed to map shared memory. (" + name_ + ")");
+        }
+
+        layout_ = static_cast<SegmentLayout*>(addr);
+        layout_->magic = SEGMENT_MAGIC;
+        layout_->version = SEGMENT_VERSION;
+        layout_->sequence.store(0, std::memory_order_relaxed);
+        publish();
+
+        th_ = std::thread(&Impl::run, this);
+    }
+
+    ~Impl(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cond_.notify_one();
+        th_.join();
+
+        munmap(layout_, sizeof(SegmentLayout));
+        shm_unlink(name_.c_str());
+    }
+
+    void run(void)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!cond_.wait_for(lock, interval_, [this] { return stop_; }))
+        {
+            lock.unlock();
+            publish();
+            lock.lock();
+        }
+    }
+
+    void publish(void)
+    {
+        StatsSegmentData data;
+        fill(data, stats_->totals());
+
+        const uint64_t seq = layout_->sequence.load(std::memory_order_relaxed);
+        layout_->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&layout_->data, &data, sizeof(data));
+        layout_->sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    std::string name_;
+    std::shared_ptr<ServerStats> stats_;
+    std::chrono::milliseconds interval_;
+    SegmentLayout* layout_;
+    bool stop_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::thread th_;
+};
+
+StatsPublisher::StatsPublisher(const char* port,
+                               const std::shared_ptr<ServerStats>& stats,
+                               const uint32_t interval_msec)
+  : pimpl_(new Impl(port, stats, interval_msec))
+{
+}
+
+StatsPublisher::~StatsPublisher(void)
+{
+}
+
+std::string StatsPublisher::segment_name(const char* port)
+{
+    return std::string("/stdsc_stats_") + port;
+}
+
+//
+// StatsSegmentReader
+//
+
+struct StatsSegmentReader::Impl
+{
+    explicit Impl(const char* port) : layout_(nullptr)
+    {
+        const std::string name = StatsPublisher::segment_name(port);
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        STDSC_THROW_FILE_IF_CHECK(0 <= fd, "Failed to open shared memory. (" +
+                                             name + ")");
+        struct stat st;
+        bool valid = (0 == fstat(fd, &st) &&
+                      sizeof(SegmentLayout) <=
+                        static_cast<std::size_t>(st.st_size));
+        void* addr = valid ? mmap(nullptr, sizeof(SegmentLayout), PROT_READ,
+                                  MAP_SHARED, fd, 0)
+                           : MAP_FAILED;
+        close(fd);
+        STDSC_THROW_FILE_IF_CHECK(MAP_FAILED != addr,
+                                  "Failed to map shared memory. (" + name + ")");
+
+        layout_ = static_cast<const SegmentLayout*>(addr);
+        if (SEGMENT_MAGIC != layout_->magic ||
+            SEGMENT_VERSION != layout_->version)
+        {
+            munmap(const_cast<SegmentLayout*>(layout_), sizeof(SegmentLayout));
+            STDSC_THROW_FILE("Unsupported statistics segment. (" + name + ")");
+        }
+    }
+
+    ~Impl(void)
+    {
+        munmap(const_cast<SegmentLayout*>(layout_), sizeof(SegmentLayout));
+    }
+
+    void read(StatsSegmentData& data) const
+    {
+        for (;;)
+        {
+            const uint64_t seq =
+              layout_->sequence.load(std::memory_order_acquire);
+            if (seq & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(&data, &layout_->data, sizeof(data));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq == layout_->sequence.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+    }
+
+    const SegmentLayout* layout_;
+};
+
+StatsSegmentReader::StatsSegmentReader(const char* port)
+  : pimpl_(new Impl(port))
+{
+}
+
+void StatsSegmentReader::read(StatsSegmentData& data) const
+{
+    pimpl_->read(data);
+}
+
+} /* namespace stdsc */
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_STATS_SEGMENT_HPP
+#define STDSC_STATS_SEGMENT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <stdsc/stdsc_define.hpp>
+
+namespace stdsc
+{
+
+class ServerStats;
+
+/**
+ * @brief Counters of a control code in the statistics segment.
+ * The values are totals since the server started.
+ */
+struct StatsSegmentCode
+{
+    uint64_t code;
+    uint64_t requests;
+    uint64_t rejects;
+    uint64_t bytes_received;
+    uint64_t bytes_sent;
+    uint64_t callback_ns;     ///< total time of the callback phase
+    uint64_t busy_ns;         ///< total time of all phases
+    uint64_t callback_p50_ns;
+    uint64_t callback_p99_ns;
+};
+
+/**
+ * @brief Contents of the statistics segment.
+ */
+struct StatsSegmentData
+{
+    uint64_t pid;                ///< process ID of the server
+    uint64_t update_ns;          ///< time of the update (ns since epoch)
+    uint64_t elapsed_ns;         ///< time since the server started
+    uint64_t connections;        ///< accepted connections
+    uint64_t active_connections; ///< connections being served
+    uint64_t num_codes;
+    StatsSegmentCode codes[STDSC_STATS_MAX_CODES];
+};
+
+/**
+ * @brief Publishes the statistics of a server into the shared memory
+ * segment named after the port (see segment_name()), from a thread of its
+ * own. The readers retry while an update is in progress (seqlock), so
+ * neither the server nor the readers take locks. The segment is removed on
+ * destruction.
+ */
+class StatsPublisher
+{
+public:
+    StatsPublisher(const char* port, const std::shared_ptr<ServerStats>& stats,
+                   const uint32_t interval_msec =
+                     STDSC_STATS_PUBLISH_INTERVAL_MSEC);
+    ~StatsPublisher(void);
+
+    StatsPublisher(const StatsPublisher&) = delete;
+    StatsPublisher& operator=(const StatsPublisher&) = delete;
+
+    /**
+     * Returns the name of the segment of the port, e.g. "/stdsc_stats_8080".
+     */
+    static std::string segment_name(const char* port);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+/**
+ * @brief Reads the statistics segment of a server.
+ */
+class StatsSegmentReader
+{
+public:
+    /**
+     * Attaches the segment of the port. FileException is thrown if the
+     * segment does not exist.
+     */
+    explicit StatsSegmentReader(const char* port);
+    ~StatsSegmentReader(void) = default;
+
+    /**
+     * Copies a consistent version of the segment.
+     */
+    void read(StatsSegmentData& data) const;
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_STATS_SEGMENT_HPP */
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdsc/stdsc_streambuf.hpp>
+#include <stdsc/stdsc_socket.hpp>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_log.hpp>
+
+namespace stdsc
+{
+
+/* CountingStreamBuf */
+
+CountingStreamBuf::CountingStreamBuf(void) : count_(0)
+{
+    setp(scratch_, scratch_ + sizeof(scratch_));
+}
+
+std::size_t CountingStreamBuf::count(void) const
+{
+    return count_ + static_cast<std::size_t>(pptr() - pbase());
+}
+
+CountingStreamBuf::int_type CountingStreamBuf::overflow(int_type c)
+{
+    count_ += static_cast<std::size_t>(pptr() - pbase());
+    setp(scratch_, scratch_ + sizeof(scratch_));
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        ++count_;
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize CountingStreamBuf::xsputn(const char* s, std::streamsize n)
+{
+    count_ += static_cast<std::size_t>(n);
+    return n;
+}
+
+/* SocketOStreamBuf */
+
+SocketOStreamBuf::SocketOStreamBuf(const Socket& sock, std::size_t size,
+                                   std::size_t chunk_size)
+  : sock_(sock),
+    remain_(size),
+    chunk_(std::max<std::size_t>(std::min(size, chunk_size), 1)),
+    is_finished_(false)
+{
+    setp(chunk_.data(), chunk_.data() + chunk_.size());
+}
+
+SocketOStreamBuf::~SocketOStreamBuf(void)
+{
+    if (!is_finished_)
+    {
+        try
+        {
+            send_chunk();
+        }
+        catch (const AbstractException& e)
+        {
+            STDSC_LOG_WARN("Failed to send stream (%s)", e.what());
+        }
+    }
+}
+
+void SocketOStreamBuf::finish(void)
+{
+    send_chunk();
+    is_finished_ = true;
+    STDSC_THROW_FAILURE_IF_CHECK(0 == remain_,
+                                 "Stream is shorter than the size.");
+}
+
+SocketOStreamBuf::int_type SocketOStreamBuf::overflow(int_type c)
+{
+    send_chunk();
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize SocketOStreamBuf::xsputn(const char* s, std::streamsize n)
+{
+    const auto size = static_cast<std::size_t>(n);
+    const auto space = static_cast<std::size_t>(epptr() - pptr());
+
+    if (size <= space)
+    {
+        std::memcpy(pptr(), s, size);
+        pbump(static_cast<int>(size));
+    }
+    else
+    {
+        /* send the large output directly, without copying into the chunk */
+        send_chunk();
+        send(s, size);
+    }
+    return n;
+}
+
+int SocketOStreamBuf::sync(void)
+{
+    send_chunk();
+    return 0;
+}
+
+void SocketOStreamBuf::send_chunk(void)
+{
+    send(pbase(), static_cast<std::size_t>(pptr() - pbase()));
+    setp(chunk_.data(), chunk_.data() + chunk_.size());
+}
+
+void SocketOStreamBuf::send(const char* s, std::size_t n)
+{
+    STDSC_THROW_FAILURE_IF_CHECK(n <= remain_, "Stream exceeds the size.");
+    sock_.send_bytes(s, n);
+    remain_ -= n;
+}
+
+/* SocketIStreamBuf */
+
+SocketIStreamBuf::SocketIStreamBuf(const Socket& sock, std::size_t size,
+                                   std::size_t chunk_size)
+  : sock_(sock),
+    remain_(size),
+    chunk_(std::max<std::size_t>(std::min(size, chunk_size), 1))
+{
+    setg(chunk_.data(), chunk_.data(), chunk_.data());
+}
+
+void SocketIStreamBuf::finish(void)
+{
+    setg(chunk_.data(), chunk_.data(), chunk_.data());
+    while (0 < remain_)
+    {
+        std::size_t n = std::min(remain_, chunk_.size());
+        sock_.recv_bytes(chunk_.data(), n);
+        remain_ -= n;
+    }
+}
+
+SocketIStreamBuf::int_type SocketIStreamBuf::underflow(void)
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+    if (0 == remain_)
+    {
+        return traits_type::eof();
+    }
+
+    std::size_t n = std::min(remain_, chunk_.size());
+    sock_.recv_bytes(chunk_.data(), n);
+    remain_ -= n;
+    setg(chunk_.data(), chunk_.data(), chunk_.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize SocketIStreamBuf::xsgetn(char* s, std::streamsize n)
+{
+    auto size = static_cast<std::size_t>(n);
+
+    /* take the buffered input first */
+    auto buffered = std::min(size, static_cast<std::size_t>(egptr() - gptr()));
+    std::memcpy(s, gptr(), buffered);
+    gbump(static_cast<int>(buffered));
+    s += buffered;
+    size -= buffered;
+
+    if (0 < size && chunk_.size() <= size)
+    {
+        /* receive the large input directly, without copying from the chunk */
+        std::size_t direct = std::min(size, remain_);
+        sock_.recv_bytes(s, direct);
+        remain_ -= direct;
+        s += direct;
+        size -= direct;
+    }
+
+    while (0 < size && !traits_type::eq_int_type(underflow(), traits_type::eof()))
+    {
+        auto k = std::min(size, static_cast<std::size_t>(egptr() - gptr()));
+        std::memcpy(s, gptr(), k);
+        gbump(static_cast<int>(k));
+        s += k;
+        size -= k;
+    }
+
+    return n - static_cast<std::streamsize>(size);
+}
+
+} /* namespace stdsc */
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_STREAMBUF_HPP
+#define STDSC_STREAMBUF_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <stdsc/stdsc_define.hpp>
+
+namespace stdsc
+{
+
+class Socket;
+
+/**
+ * @brief Provides a streambuf which counts and discards the output.
+ * The single characters are put into a small scratch area, so that they
+ * are counted without a virtual call each.
+ */
+class CountingStreamBuf : public std::streambuf
+{
+public:
+    CountingStreamBuf(void);
+    virtual ~CountingStreamBuf(void) = default;
+
+    CountingStreamBuf(const CountingStreamBuf&) = delete;
+    CountingStreamBuf& operator=(const CountingStreamBuf&) = delete;
+
+    std::size_t count(void) const;
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+private:
+    std::size_t count_; ///< characters counted before the scratch area
+    char scratch_[256];
+};
+
+/**
+ * @brief Provides a streambuf which sends the output to the socket.
+ * The size of the output must be known up front, and the output is sent in
+ * chunks of `chunk_size` bytes. The large writes are sent directly.
+ */
+class SocketOStreamBuf : public std::streambuf
+{
+public:
+    SocketOStreamBuf(const Socket& sock, std::size_t size,
+                     std::size_t chunk_size = STDSC_STREAM_CHUNK_SIZE);
+    virtual ~SocketOStreamBuf(void);
+
+    SocketOStreamBuf(const SocketOStreamBuf&) = delete;
+    SocketOStreamBuf& operator=(const SocketOStreamBuf&) = delete;
+
+    /**
+     * Sends the remaining output, and checks that all bytes have been
+     * written.
+     */
+    void finish(void);
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync(void) override;
+
+private:
+    void send_chunk(void);
+    void send(const char* s, std::size_t n);
+
+    const Socket& sock_;
+    std::size_t remain_;
+    std::vector<char> chunk_;
+    bool is_finished_;
+};
+
+/**
+ * @brief Provides a streambuf which receives the input from the socket.
+ * `size` bytes are received in chunks of `chunk_size` bytes as the input is
+ * read. The large reads are received directly.
+ */
+class SocketIStreamBuf : public std::streambuf
+{
+public:
+    SocketIStreamBuf(const Socket& sock, std::size_t size,
+                     std::size_t chunk_size = STDSC_STREAM_CHUNK_SIZE);
+    virtual ~SocketIStreamBuf(void) = default;
+
+    SocketIStreamBuf(const SocketIStreamBuf&) = delete;
+    SocketIStreamBuf& operator=(const SocketIStreamBuf&) = delete;
+
+    /**
+     * Receives and discards the input which has not been read.
+     */
+    void finish(void);
+
+protected:
+    int_type underflow(void) override;
+    std::streamsize xsgetn(char* s, std::streamsize n) override;
+
+private:
+    const Socket& sock_;
+    std::size_t remain_;
+    std::vector<char> chunk_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_STREAMBUF_HPP */
@@ -0,0 +1,853 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_TEXT_CODEC_HPP
+#define STDSC_TEXT_CODEC_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <stdsc/stdsc_define.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+namespace stdsc
+{
+
+namespace text_codec
+{
+
+inline bool is_space(const char c)
+{
+    return c == ' ' || (static_cast<unsigned char>(c - '\t') <= '\r' - '\t');
+}
+
+/**
+ * Returns the first non-whitespace character in [p, end).
+ */
+inline const char* skip_space(const char* p, const char* end)
+{
+    while (p < end && is_space(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Returns the first whitespace character in [p, end).
+ * Sixteen characters are scanned at once with SSE2.
+ */
+inline const char* find_space(const char* p, const char* end)
+{
+#if defined(__SSE2__)
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i range = _mm_set1_epi8('\r' - '\t');
+    while (16 <= end - p)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i t = _mm_sub_epi8(x, tab);
+        __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(t, range), t);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(x, sp), ctrl));
+        if (mask)
+        {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && !is_space(*p))
+    {
+        ++p;
+    }
+    return p;
+}
+
+/**
+ * Array of characters which is left uninitialized, unlike std::vector, so
+ * that a large buffer costs nothing beyond the part written to.
+ */
+class CharBuffer
+{
+public:
+    explicit CharBuffer(const std::size_t size)
+      : data_(new char[size]), size_(size)
+    {
+    }
+
+    char* data(void)
+    {
+        return data_.get();
+    }
+    std::size_t size(void) const
+    {
+        return size_;
+    }
+    char& operator[](const std::size_t i)
+    {
+        return data_[i];
+    }
+
+    /* keeps the first `keep` characters */
+    void resize(const std::size_t size, const std::size_t keep)
+    {
+        std::unique_ptr<char[]> data(new char[size]);
+        std::memcpy(data.get(), data_.get(), std::min(keep, size));
+        data_.swap(data);
+        size_ = size;
+    }
+
+private:
+    std::unique_ptr<char[]> data_;
+    std::size_t size_;
+};
+
+/**
+ * Reads whitespace separated tokens from a streambuf one character at a
+ * time. The whitespace following the last token is not consumed, so
+ * nothing is lost on streams which can not seek back.
+ */
+class TokenReader
+{
+public:
+    explicit TokenReader(std::streambuf* sb) : sb_(sb)
+    {
+    }
+
+    /**
+     * Sets [p, end) to the next token, which is valid until the next call.
+     * Returns false at the end of the stream.
+     */
+    bool next(const char*& p, const char*& end)
+    {
+        using traits = std::streambuf::traits_type;
+        token_.clear();
+        auto c = sb_->sgetc();
+        while (!traits::eq_int_type(c, traits::eof()) &&
+               is_space(traits::to_char_type(c)))
+        {
+            c = sb_->snextc();
+        }
+        while (!traits::eq_int_type(c, traits::eof()) &&
+               !is_space(traits::to_char_type(c)))
+        {
+            token_.push_back(traits::to_char_type(c));
+            c = sb_->snextc();
+        }
+        p = token_.data();
+        end = p + token_.size();
+        return !token_.empty();
+    }
+
+    bool finish(void)
+    {
+        return true;
+    }
+
+private:
+    std::streambuf* sb_;
+    std::string token_;
+};
+
+/**
+ * Reads whitespace separated tokens from a seekable streambuf a chunk at
+ * a time. finish() seeks the streambuf back to the end of the last token.
+ */
+class ChunkReader
+{
+public:
+    /* The first chunk is sized by in_avail(), which is the rest of the
+     * data for BufferStream and file streams, so small data is read into
+     * a small buffer. */
+    explicit ChunkReader(std::streambuf* sb)
+      : sb_(sb), buf_(initial_size(sb)), p_(buf_.data()), end_(p_),
+        eof_(false)
+    {
+    }
+
+    static bool is_seekable(std::streambuf* sb)
+    {
+        return sb->pubseekoff(0, std::ios::cur, std::ios::in) !=
+               std::streampos(std::streamoff(-1));
+    }
+
+    /**
+     * Sets [p, end) to the next token, which is valid until the next call.
+     * Returns false at the end of the stream.
+     */
+    bool next(const char*& p, const char*& end)
+    {
+        for (;;)
+        {
+            p_ = skip_space(p_, end_);
+            if (p_ == end_ && !eof_)
+            {
+                fill();
+                continue;
+            }
+            const char* q = find_space(p_, end_);
+            if (q == end_ && !eof_)
+            {
+                fill();
+                continue;
+            }
+            p = p_;
+            end = q;
+            p_ = q;
+            return p != end;
+        }
+    }
+
+    /**
+     * Gives back the bytes read past the last token. Returns false if the
+     * streambuf could not seek back.
+     */
+    bool finish(void)
+    {
+        if (p_ == end_)
+        {
+            return true;
+        }
+        const auto off = -static_cast<std::streamoff>(end_ - p_);
+        p_ = end_;
+        return sb_->pubseekoff(off, std::ios::cur, std::ios::in) !=
+               std::streampos(std::streamoff(-1));
+    }
+
+private:
+    static std::size_t initial_size(std::streambuf* sb)
+    {
+        const auto avail = sb->in_avail();
+        const std::size_t min_size = 256;
+        if (avail <= 0)
+        {
+            return min_size;
+        }
+        return std::max(min_size,
+                        std::min<std::size_t>(
+                          static_cast<std::size_t>(avail) + 1,
+                          STDSC_STREAM_CHUNK_SIZE));
+    }
+
+    /* Moves the unread bytes to the front and reads the rest of the chunk.
+     * The chunk is doubled, up to STDSC_STREAM_CHUNK_SIZE, if the previous
+     * read filled it, and beyond that if a single token fills it. */
+    void fill(void)
+    {
+        const std::size_t offset = static_cast<std::size_t>(p_ - buf_.data());
+        const std::size_t rest = static_cast<std::size_t>(end_ - p_);
+        const bool full = end_ == buf_.data() + buf_.size();
+        if (rest)
+        {
+            std::memmove(buf_.data(), buf_.data() + offset, rest);
+        }
+        if (full && (offset == 0 || buf_.size() < STDSC_STREAM_CHUNK_SIZE))
+        {
+            buf_.resize(buf_.size() * 2, rest);
+        }
+        const auto room = static_cast<std::streamsize>(buf_.size() - rest);
+        const auto n = sb_->sgetn(buf_.data() + rest, room);
+        eof_ = n < room;
+        p_ = buf_.data();
+        end_ = p_ + rest + n;
+    }
+
+    std::streambuf* sb_;
+    CharBuffer buf_;
+    const char* p_;
+    const char* end_;
+    bool eof_;
+};
+
+template <class T>
+inline std::size_t format_unsigned(char* buf, T v)
+{
+    char tmp[std::numeric_limits<T>::digits10 + 1];
+    char* q = tmp + sizeof(tmp);
+    do
+    {
+        *--q = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    std::size_t len = static_cast<std::size_t>(tmp + sizeof(tmp) - q);
+    std::memcpy(buf, q, len);
+    return len;
+}
+
+template <class T>
+inline std::size_t format_value(char* buf, const T v, std::true_type)
+{
+    using U = typename std::make_unsigned<T>::type;
+    if (v < 0)
+    {
+        *buf = '-';
+        return 1 + format_unsigned(buf + 1, static_cast<U>(0 - static_cast<U>(v)));
+    }
+    return format_unsigned(buf, static_cast<U>(v));
+}
+
+template <class T>
+inline std::size_t format_value(char* buf, const T v, std::false_type)
+{
+    return format_unsigned(buf, v);
+}
+
+template <class T>
+inline bool parse_integer(const char* p, const char* end, T& v)
+{
+    using U = typename std::make_unsigned<T>::type;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        neg = (*p++ == '-');
+    }
+    if (p == end)
+    {
+        return false;
+    }
+
+    const U limit = std::is_signed<T>::value
+                      ? static_cast<U>(static_cast<U>(std::numeric_limits<T>::max()) + neg)
+                      : std::numeric_limits<U>::max();
+    /* numbers up to digits10 digits cannot overflow */
+    const char* safe_end = p + std::numeric_limits<T>::digits10;
+    U u = 0;
+    for (; p < end; ++p)
+    {
+        unsigned d = static_cast<unsigned char>(*p - '0');
+        if (9 < d || (safe_end <= p && (limit - d) / 10 < u))
+        {
+            return false;
+        }
+        u = static_cast<U>(u * 10 + d);
+    }
+    v = static_cast<T>(neg ? 0 - u : u);
+    return true;
+}
+
+inline const double* exact_powers_of_ten(void)
+{
+    static const double table[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    return table;
+}
+
+/**
+ * Formats the value as printf("%.*g") does. The digits are computed with
+ * a scaling by an exact power of ten, and snprintf is used only when the
+ * value is out of range or too close to a rounding tie to be exact.
+ */
+inline std::size_t format_floating(char* buf, const std::size_t size,
+                                   const double v, const int precision)
+{
+    const int p = precision == 0 ? 1 : precision;
+    double a = std::fabs(v);
+    if (9 < p || !std::isfinite(v) || a == 0.0)
+    {
+        return static_cast<std::size_t>(std::snprintf(buf, size, "%.*g", p, v));
+    }
+
+    const double* pow10 = exact_powers_of_ten();
+    int e = static_cast<int>(std::floor(std::log10(a)));
+    uint64_t digits = 0;
+    for (;;)
+    {
+        int k = p - 1 - e;
+        if (k < -22 || 22 < k)
+        {
+            return static_cast<std::size_t>(
+              std::snprintf(buf, size, "%.*g", p, v));
+        }
+        double scaled = k < 0 ? a / pow10[-k] : a * pow10[k];
+        double fl = std::floor(scaled);
+        if (std::fabs(scaled - fl - 0.5) < 1e-6)
+        {
+            return static_cast<std::size_t>(
+              std::snprintf(buf, size, "%.*g", p, v));
+        }
+        digits = static_cast<uint64_t>(fl) + (0.5 < scaled - fl ? 1 : 0);
+        const uint64_t lower = static_cast<uint64_t>(pow10[p - 1]);
+        if (digits < lower)
+        {
+            --e;
+            continue;
+        }
+        if (lower * 10 <= digits)
+        {
+            digits /= 10;
+            ++e;
+        }
+        break;
+    }
+
+    char d[16];
+    format_unsigned(d, digits);
+    int n = p;
+    while (1 < n && d[n - 1] == '0')
+    {
+        --n;
+    }
+
+    char* q = buf;
+    if (v < 0)
+    {
+        *q++ = '-';
+    }
+    if (e < -4 || p <= e)
+    {
+        *q++ = d[0];
+        if (1 < n)
+        {
+            *q++ = '.';
+            std::memcpy(q, d + 1, n - 1);
+            q += n - 1;
+        }
+        *q++ = 'e';
+        *q++ = e < 0 ? '-' : '+';
+        unsigned ae = static_cast<unsigned>(e < 0 ? -e : e);
+        if (ae < 10)
+        {
+            *q++ = '0';
+        }
+        q += format_unsigned(q, ae);
+    }
+    else if (e < 0)
+    {
+        *q++ = '0';
+        *q++ = '.';
+        for (int i = -1; e < i; --i)
+        {
+            *q++ = '0';
+        }
+        std::memcpy(q, d, n);
+        q += n;
+    }
+    else
+    {
+        std::memcpy(q, d, e + 1 < n ? e + 1 : n);
+        q += e + 1 < n ? e + 1 : n;
+        for (int i = n; i < e + 1; ++i)
+        {
+            *q++ = '0';
+        }
+        if (e + 1 < n)
+        {
+            *q++ = '.';
+            std::memcpy(q, d + e + 1, n - e - 1);
+            q += n - e - 1;
+        }
+    }
+    return static_cast<std::size_t>(q - buf);
+}
+
+template <class T>
+inline bool parse_floating_slow(const char* p, const char* end, T& v)
+{
+    char buf[64];
+    std::string str;
+    const std::size_t len = static_cast<std::size_t>(end - p);
+    const char* s = buf;
+    if (len < sizeof(buf))
+    {
+        std::memcpy(buf, p, len);
+        buf[len] = '\0';
+    }
+    else
+    {
+        str.assign(p, len);
+        s = str.c_str();
+    }
+    char* q = nullptr;
+    if (std::is_same<T, float>::value)
+    {
+        v = static_cast<T>(std::strtof(s, &q));
+    }
+    else
+    {
+        v = static_cast<T>(std::strtod(s, &q));
+    }
+    return q == s + len;
+}
+
+/**
+ * Parses a decimal floating point number. When the significand and the
+ * power of ten are both exact in T, a single multiplication or division
+ * rounds correctly; strtod is used otherwise.
+ */
+template <class T>
+inline bool parse_floating(const char* p, const char* end, T& v)
+{
+    const char* begin = p;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        neg = (*p++ == '-');
+    }
+
+    uint64_t m = 0;
+    int ndigits = 0;
+    int exp10 = 0;
+    bool any = false;
+    for (; p < end && static_cast<unsigned char>(*p - '0') <= 9; ++p, any = true)
+    {
+        if (m != 0 || *p != '0')
+        {
+            m = m * 10 + static_cast<unsigned>(*p - '0');
+            ++ndigits;
+        }
+        if (19 <= ndigits)
+        {
+            return parse_floating_slow(begin, end, v);
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && static_cast<unsigned char>(*p - '0') <= 9;
+             ++p, any = true)
+        {
+            if (m != 0 || *p != '0')
+            {
+                m = m * 10 + static_cast<unsigned>(*p - '0');
+                ++ndigits;
+            }
+            --exp10;
+            if (19 <= ndigits)
+            {
+                return parse_floating_slow(begin, end, v);
+            }
+        }
+    }
+    if (!any)
+    {
+        return parse_floating_slow(begin, end, v);
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        int x = 0;
+        if (!parse_integer(p, end, x) || x < -1000 || 1000 < x)
+        {
+            return parse_floating_slow(begin, end, v);
+        }
+        exp10 += x;
+        p = end;
+    }
+    if (p != end)
+    {
+        return false;
+    }
+
+    const int max_exp10 = std::is_same<T, float>::value ? 10 : 22;
+    const uint64_t max_m = uint64_t(1) << std::numeric_limits<T>::digits;
+    if (max_m < m || exp10 < -max_exp10 || max_exp10 < exp10)
+    {
+        return parse_floating_slow(begin, end, v);
+    }
+    const double* pow10 = exact_powers_of_ten();
+    T r = static_cast<T>(m);
+    if (exp10 < 0)
+    {
+        r /= static_cast<T>(pow10[-exp10]);
+    }
+    else
+    {
+        r *= static_cast<T>(pow10[exp10]);
+    }
+    v = neg ? -r : r;
+    return true;
+}
+
+/**
+ * @brief Provides the conversion of an element between text.
+ * The conversion is equivalent to operator<< and operator>> with the
+ * default flags of streams.
+ */
+template <class T, class Enable = void>
+struct Element
+{
+    static constexpr bool fast = false;
+};
+
+template <class T>
+struct Element<T, typename std::enable_if<
+                    std::is_integral<T>::value &&
+                    !std::is_same<T, bool>::value &&
+                    !std::is_same<T, char>::value &&
+                    !std::is_same<T, signed char>::value &&
+                    !std::is_same<T, unsigned char>::value>::type>
+{
+    static constexpr bool fast = true;
+    static constexpr std::size_t max_size = std::numeric_limits<T>::digits10 + 2;
+
+    static std::size_t format(char* buf, const T v, const std::streamsize)
+    {
+        return format_value(buf, v, std::is_signed<T>());
+    }
+
+    static bool parse(const char* p, const char* end, T& v)
+    {
+        return parse_integer(p, end, v);
+    }
+};
+
+template <class T>
+struct Element<T, typename std::enable_if<
+                    std::is_same<T, float>::value ||
+                    std::is_same<T, double>::value>::type>
+{
+    static constexpr bool fast = true;
+    static constexpr std::size_t max_size = 64;
+
+    static std::size_t format(char* buf, const T v,
+                              const std::streamsize precision)
+    {
+        return format_floating(buf, max_size, static_cast<double>(v),
+                               static_cast<int>(precision));
+    }
+
+    static bool parse(const char* p, const char* end, T& v)
+    {
+        return parse_floating(p, end, v);
+    }
+};
+
+} /* namespace text_codec */
+
+/**
+ * @brief Provides the text format of a vector of elements.
+ * The format is the number of elements followed by the elements, each
+ * terminated by a newline. Integers, floating point numbers and strings
+ * are converted without streams; the stream is read in bulk and the
+ * delimiters are scanned with SIMD instructions. The other types fall back
+ * to operator<< and operator>>.
+ */
+template <class T>
+struct TextCodec
+{
+    using Element = text_codec::Element<T>;
+    using is_fast = std::integral_constant<
+      bool, Element::fast || std::is_same<T, std::string>::value>;
+
+    static void save(std::ostream& os, const std::vector<T>& vec)
+    {
+        if (vec.size() == 0)
+        {
+            return;
+        }
+        if (!is_default_format(os))
+        {
+            save_elements(os, vec, std::false_type());
+            return;
+        }
+        save_elements(os, vec, is_fast());
+    }
+
+    static void load(std::istream& is, std::vector<T>& vec)
+    {
+        load_elements(is, vec, is_fast());
+    }
+
+private:
+    static bool is_default_format(std::ostream& os)
+    {
+        return os.flags() == (std::ios::skipws | std::ios::dec) &&
+               os.width() == 0 && os.getloc() == std::locale::classic();
+    }
+
+    static void save_elements(std::ostream& os, const std::vector<T>& vec,
+                              std::false_type)
+    {
+        os << vec.size() << '\n';
+        for (const auto& v : vec)
+        {
+            os << v << '\n';
+        }
+        os.flush();
+    }
+
+    /* Upper bound of the size written by save_elements, which sizes the
+     * buffer for small data. */
+    template <class U>
+    static std::size_t estimated_size(const std::vector<U>& vec)
+    {
+        const std::size_t line = text_codec::Element<U>::max_size + 1;
+        return 32 + std::min(vec.size(), STDSC_STREAM_CHUNK_SIZE / line) * line;
+    }
+
+    static std::size_t estimated_size(const std::vector<std::string>& vec)
+    {
+        std::size_t size = 32;
+        for (const auto& v : vec)
+        {
+            size += v.size() + 1;
+            if (STDSC_STREAM_CHUNK_SIZE <= size)
+            {
+                break;
+            }
+        }
+        return size;
+    }
+
+    static void save_elements(std::ostream& os, const std::vector<T>& vec,
+                              std::true_type)
+    {
+        text_codec::CharBuffer out(std::min<std::size_t>(
+          STDSC_STREAM_CHUNK_SIZE, estimated_size(vec)));
+        std::size_t pos = text_codec::format_value(out.data(), vec.size(),
+                                                   std::false_type());
+        out[pos++] = '\n';
+        const auto precision = os.precision();
+        for (const auto& v : vec)
+        {
+            pos = append(os, out, pos, v, precision);
+        }
+        os.write(out.data(), pos);
+        os.flush();
+    }
+
+    template <class U>
+    static std::size_t append(std::ostream& os, text_codec::CharBuffer& out,
+                              std::size_t pos, const U& v,
+                              const std::streamsize precision)
+    {
+        if (out.size() - pos < text_codec::Element<U>::max_size + 1)
+        {
+            os.write(out.data(), pos);
+            pos = 0;
+        }
+        pos += text_codec::Element<U>::format(&out[pos], v, precision);
+        out[pos++] = '\n';
+        return pos;
+    }
+
+    static std::size_t append(std::ostream& os, text_codec::CharBuffer& out,
+                              std::size_t pos, const std::string& v,
+                              const std::streamsize)
+    {
+        if (out.size() - pos < v.size() + 1)
+        {
+            os.write(out.data(), pos);
+            pos = 0;
+            if (out.size() < v.size() + 1)
+            {
+                os.write(v.data(), v.size());
+                os.put('\n');
+                return pos;
+            }
+        }
+        std::memcpy(&out[pos], v.data(), v.size());
+        pos += v.size();
+        out[pos++] = '\n';
+        return pos;
+    }
+
+    static void load_elements(std::istream& is, std::vector<T>& vec,
+                              std::false_type)
+    {
+        vec.clear();
+        size_t sz = 0;
+        if (!(is >> sz))
+        {
+            return;
+        }
+        vec.reserve(sz);
+        for (size_t i = 0; i < sz; ++i)
+        {
+            T v;
+            is >> v;
+            vec.push_back(v);
+        }
+    }
+
+    /**
+     * Reads seekable streams a chunk at a time and gives back the bytes
+     * read past the elements. Other streams (e.g. SocketIStreamBuf) are
+     * read token by token, so that nothing after the elements is consumed.
+     */
+    static void load_elements(std::istream& is, std::vector<T>& vec,
+                              std::true_type)
+    {
+        auto* sb = is.rdbuf();
+        if (text_codec::ChunkReader::is_seekable(sb))
+        {
+            text_codec::ChunkReader reader(sb);
+            load_tokens(reader, vec);
+        }
+        else
+        {
+            text_codec::TokenReader reader(sb);
+            load_tokens(reader, vec);
+        }
+    }
+
+    template <class R>
+    static void load_tokens(R& reader, std::vector<T>& vec)
+    {
+        vec.clear();
+        const char* p;
+        const char* q;
+        if (!reader.next(p, q))
+        {
+            return;
+        }
+        uint64_t sz = 0;
+        STDSC_THROW_FAILURE_IF_CHECK(text_codec::parse_integer(p, q, sz),
+                                     "Invalid number of elements.");
+
+        vec.reserve(static_cast<std::size_t>(
+          std::min<uint64_t>(sz, STDSC_STREAM_CHUNK_SIZE)));
+        for (uint64_t i = 0; i < sz; ++i)
+        {
+            T v;
+            STDSC_THROW_FAILURE_IF_CHECK(reader.next(p, q) && parse(p, q, v),
+                                         "Invalid element.");
+            vec.push_back(v);
+        }
+        STDSC_THROW_FAILURE_IF_CHECK(
+          reader.finish(), "Failed to seek back to the end of the elements.");
+    }
+
+    template <class U>
+    static bool parse(const char* p, const char* end, U& v)
+    {
+        return text_codec::Element<U>::parse(p, end, v);
+    }
+
+    static bool parse(const char* p, const char* end, std::string& v)
+    {
+        v.assign(p, end);
+        return true;
+    }
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_TEXT_CODEC_HPP */
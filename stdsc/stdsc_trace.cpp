@@ -0,0 +1,258 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_stats.hpp>
+#include <stdsc/stdsc_trace.hpp>
+
+namespace stdsc
+{
+
+std::atomic<bool> g_trace_enabled(false);
+
+namespace
+{
+
+struct TraceEvent
+{
+    const char* name;
+    uint64_t code;
+    uint64_t request_id;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+};
+
+/**
+ * @brief Spans recorded by a thread. The lock is taken by the thread for
+ * each span, and by the tracer only to clear or save them.
+ */
+struct ThreadEvents
+{
+    explicit ThreadEvents(const uint64_t tid) : tid(tid)
+    {
+    }
+
+    std::mutex mtx;
+    std::vector<TraceEvent> events;
+    const uint64_t tid;
+};
+
+} /* namespace */
+
+struct Tracer::Impl
+{
+    Impl(void)
+      : max_events_(STDSC_TRACE_MAX_EVENTS),
+        enabled_(false),
+        dropped_(0),
+        next_id_(0)
+    {
+    }
+
+    ThreadEvents& local_events(void)
+    {
+        /* the buffer is kept by the tracer after the thread exits */
+        thread_local const Impl* owner = nullptr;
+        thread_local std::shared_ptr<ThreadEvents> local;
+        if (owner != this)
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            local = std::make_shared<ThreadEvents>(threads_.size() + 1);
+            threads_.push_back(local);
+            owner = this;
+        }
+        return *local;
+    }
+
+    void record(const TraceEvent& event)
+    {
+        if (!enabled_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        ThreadEvents& local = local_events();
+        std::lock_guard<std::mutex> lock(local.mtx);
+        if (max_events_ <= local.events.size())
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        local.events.push_back(event);
+    }
+
+    void save(FILE* fp) const
+    {
+        const long pid = static_cast<long>(getpid());
+        fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        bool first = true;
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (const auto& thread : threads_)
+        {
+            std::lock_guard<std::mutex> thread_lock(thread->mtx);
+            for (const auto& e : thread->events)
+            {
+                fprintf(fp,
+                        "%s{\"name\":\"%s\",\"cat\":\"stdsc\",\"ph\":\"X\","
+                        "\"ts\":%" PRIu64 ".%03" PRIu64 ",\"dur\":%" PRIu64
+                        ".%03" PRIu64 ",\"pid\":%ld,\"tid\":%" PRIu64 ","
+                        "\"args\":{\"code\":\"0x%" PRIx64 "\","
+                        "\"request_id\":\"0x%" PRIx64 "\"}}",
+                        first ? "" : ",\n", e.name, e.begin_ns / 1000,
+                        e.begin_ns % 1000, (e.end_ns - e.begin_ns) / 1000,
+                        (e.end_ns - e.begin_ns) % 1000, pid, thread->tid,
+                        e.code, e.request_id);
+                first = false;
+            }
+        }
+        fprintf(fp, "\n]}\n");
+    }
+
+    mutable std::mutex mtx_;
+    std::vector<std::shared_ptr<ThreadEvents>> threads_;
+    std::size_t max_events_;
+    std::atomic<bool> enabled_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> next_id_;
+};
+
+Tracer::Tracer(void) : pimpl_(new Impl())
+{
+}
+
+Tracer& Tracer::instance(void)
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::enable(const std::size_t max_events)
+{
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mtx_);
+        for (auto& thread : pimpl_->threads_)
+        {
+            std::lock_guard<std::mutex> thread_lock(thread->mtx);
+            thread->events.clear();
+        }
+        pimpl_->max_events_ = max_events;
+        pimpl_->dropped_ = 0;
+    }
+    pimpl_->enabled_ = true;
+    if (this == &instance())
+    {
+        g_trace_enabled = true;
+    }
+}
+
+void Tracer::disable(void)
+{
+    if (this == &instance())
+    {
+        g_trace_enabled = false;
+    }
+    pimpl_->enabled_ = false;
+}
+
+void Tracer::save(const std::string& filepath) const
+{
+    FILE* fp = fopen(filepath.c_str(), "w");
+    STDSC_THROW_FILE_IF_CHECK(fp != nullptr,
+                              "Failed to open trace file. (" + filepath + ")");
+    pimpl_->save(fp);
+    bool failed = ferror(fp);
+    failed |= (0 != fclose(fp));
+    STDSC_THROW_FILE_IF_CHECK(!failed, "Failed to write trace file. (" +
+                                         filepath + ")");
+}
+
+uint64_t Tracer::dropped_count(void) const
+{
+    return pimpl_->dropped_.load(std::memory_order_relaxed);
+}
+
+uint64_t Tracer::next_request_id(void)
+{
+    if (!pimpl_->enabled_.load(std::memory_order_relaxed))
+    {
+        return 0;
+    }
+    /* the process ID in the upper half tells the clients apart */
+    const uint64_t seq =
+      pimpl_->next_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+    return (static_cast<uint64_t>(getpid()) << 32) | (seq & 0xFFFFFFFF);
+}
+
+void Tracer::record(const char* name, const uint64_t code,
+                    const uint64_t request_id, const uint64_t begin_ns,
+                    const uint64_t end_ns)
+{
+    TraceEvent event = {name, code, request_id, begin_ns, end_ns};
+    pimpl_->record(event);
+}
+
+//
+// TraceSpan
+//
+
+TraceSpan::TraceSpan(const char* name, const uint64_t code,
+                     const uint64_t request_id)
+  : name_(name),
+    phase_name_(nullptr),
+    code_(code),
+    request_id_(request_id),
+    begin_(trace_enabled() ? RequestTiming::now() : 0),
+    phase_begin_(begin_)
+{
+}
+
+TraceSpan::~TraceSpan(void)
+{
+    if (0 == begin_)
+    {
+        return;
+    }
+    const uint64_t now = RequestTiming::now();
+    auto& tracer = Tracer::instance();
+    if (phase_name_)
+    {
+        tracer.record(phase_name_, code_, request_id_, phase_begin_, now);
+    }
+    tracer.record(name_, code_, request_id_, begin_, now);
+}
+
+void TraceSpan::phase(const char* name)
+{
+    if (0 == begin_)
+    {
+        return;
+    }
+    const uint64_t now = RequestTiming::now();
+    if (phase_name_)
+    {
+        Tracer::instance().record(phase_name_, code_, request_id_,
+                                  phase_begin_, now);
+    }
+    phase_name_ = name;
+    phase_begin_ = now;
+}
+
+} /* namespace stdsc */
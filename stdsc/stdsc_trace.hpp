@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STDSC_TRACE_HPP
+#define STDSC_TRACE_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <stdsc/stdsc_define.hpp>
+
+namespace stdsc
+{
+
+/**
+ * @brief Records spans of requests on the client and the server, and
+ * exports them as Chrome trace-event JSON (viewable in Perfetto).
+ * The spans of a request share the request ID carried in its packets, and
+ * the timestamps are of the monotonic clock, so the traces of the client
+ * and server processes on a host can be viewed together.
+ * Each thread records into its own buffer. Nothing is recorded while
+ * disabled, which costs a load per span.
+ */
+class Tracer
+{
+public:
+    Tracer(void);
+    ~Tracer(void) = default;
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    static Tracer& instance(void);
+
+    /**
+     * Discards the recorded spans and starts recording.
+     * @param[in] max_events number of spans kept per thread; the spans
+     *                       beyond are dropped and counted
+     */
+    void enable(const std::size_t max_events = STDSC_TRACE_MAX_EVENTS);
+
+    void disable(void);
+
+    /**
+     * Writes the recorded spans to the file as Chrome trace-event JSON.
+     */
+    void save(const std::string& filepath) const;
+
+    /**
+     * Returns the number of spans dropped since enable().
+     */
+    uint64_t dropped_count(void) const;
+
+    /**
+     * Returns a new request ID unique among processes, or 0 if disabled.
+     */
+    uint64_t next_request_id(void);
+
+    void record(const char* name, const uint64_t code,
+                const uint64_t request_id, const uint64_t begin_ns,
+                const uint64_t end_ns);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> pimpl_;
+};
+
+/**
+ * Whether the tracer is enabled, mirrored for the inline check.
+ */
+extern std::atomic<bool> g_trace_enabled;
+
+inline bool trace_enabled(void)
+{
+    return g_trace_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records a span from the construction to the destruction, divided
+ * into consecutive phases by phase().
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char* name, const uint64_t code,
+              const uint64_t request_id = 0);
+    ~TraceSpan(void);
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /**
+     * Ends the current phase, and starts the phase of the name.
+     */
+    void phase(const char* name);
+
+private:
+    const char* name_;
+    const char* phase_name_;
+    uint64_t code_;
+    uint64_t request_id_;
+    uint64_t begin_;       ///< 0 if disabled
+    uint64_t phase_begin_;
+};
+
+} /* namespace stdsc */
+
+#endif /* STDSC_TRACE_HPP */
@@ -0,0 +1,302 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_binary_codec.hpp>
+
+/*
+ * Round-trips vectors through the stream and the buffer paths of
+ * BinaryCodec, and checks that data with a bad header, a truncated
+ * payload or corrupt counts and lengths is refused.
+ */
+
+namespace
+{
+
+/* the offsets of the fields in the saved data */
+const std::size_t kVersionOffset = 4;
+const std::size_t kElementSizeOffset = 6;
+const std::size_t kCountOffset = 8;
+const std::size_t kElementsOffset = sizeof(stdsc::BinaryHeader);
+
+int failures = 0;
+
+/* not trivially copyable, so it is written as text by BinaryElementCodec */
+struct Point
+{
+    Point(void) : x(0), y(0)
+    {
+    }
+
+    Point(const int x, const int y) : x(x), y(y)
+    {
+    }
+
+    Point(const Point& p) : x(p.x), y(p.y)
+    {
+    }
+
+    Point& operator=(const Point& p)
+    {
+        x = p.x;
+        y = p.y;
+        return *this;
+    }
+
+    bool operator==(const Point& p) const
+    {
+        return x == p.x && y == p.y;
+    }
+
+    int x;
+    int y;
+};
+
+std::ostream& operator<<(std::ostream& os, const Point& p)
+{
+    return os << p.x << ' ' << p.y;
+}
+
+std::istream& operator>>(std::istream& is, Point& p)
+{
+    return is >> p.x >> p.y;
+}
+
+template <class T>
+std::string save(const std::vector<T>& vec)
+{
+    std::ostringstream oss;
+    stdsc::BinaryCodec<T>::save(oss, vec);
+    return oss.str();
+}
+
+template <class T>
+std::string save_to_buffer(const std::vector<T>& vec)
+{
+    stdsc::Buffer buffer(0);
+    stdsc::BufferWriter writer(buffer);
+    stdsc::BinaryCodec<T>::save(writer, vec);
+    writer.finish();
+    return std::string(static_cast<const char*>(buffer.data()), buffer.size());
+}
+
+template <class T>
+std::vector<T> load(const std::string& data)
+{
+    std::istringstream iss(data);
+    std::vector<T> vec;
+    stdsc::BinaryCodec<T>::load(iss, vec);
+    return vec;
+}
+
+/* Returns the bytes left after the data in `remaining`. */
+template <class T>
+std::vector<T> load_from_buffer(const std::string& data,
+                                std::size_t& remaining)
+{
+    stdsc::Buffer buffer(data.size());
+    std::memcpy(buffer.data(), data.data(), data.size());
+    stdsc::BufferReader reader(buffer);
+    std::vector<T> vec;
+    stdsc::BinaryCodec<T>::load(reader, vec);
+    remaining = reader.remaining();
+    return vec;
+}
+
+template <class T>
+std::vector<T> load_from_buffer(const std::string& data)
+{
+    std::size_t remaining;
+    return load_from_buffer<T>(data, remaining);
+}
+
+template <class F>
+void set_field(std::string& data, const std::size_t offset, const F v)
+{
+    std::memcpy(&data[offset], &v, sizeof(v));
+}
+
+template <class T>
+void test_round_trip(const char* name, const std::vector<T>& vec)
+{
+    const auto data = save(vec);
+    if (save_to_buffer(vec) != data)
+    {
+        printf("%s n:%zu: stream and buffer outputs differ\n", name,
+               vec.size());
+        ++failures;
+    }
+    if (stdsc::BinaryCodec<T>::stream_size(vec) != data.size())
+    {
+        printf("%s n:%zu: stream_size %zu != %zu\n", name, vec.size(),
+               stdsc::BinaryCodec<T>::stream_size(vec), data.size());
+        ++failures;
+    }
+    std::istringstream iss(data);
+    if (!stdsc::BinaryCodec<T>::is_binary(iss))
+    {
+        printf("%s n:%zu: not detected as binary\n", name, vec.size());
+        ++failures;
+    }
+    if (load<T>(data) != vec || load_from_buffer<T>(data) != vec)
+    {
+        printf("%s n:%zu: round trip failed\n", name, vec.size());
+        ++failures;
+    }
+
+    /* the bytes after the data are left to the caller */
+    std::size_t remaining;
+    if (load_from_buffer<T>(data + "tail", remaining) != vec ||
+        remaining != 4)
+    {
+        printf("%s n:%zu: following bytes not kept\n", name, vec.size());
+        ++failures;
+    }
+}
+
+template <class T>
+void expect_refused(const char* name, const std::string& data)
+{
+    std::vector<T> vec;
+    try
+    {
+        vec = load<T>(data);
+        printf("%s: stream load accepted %zu elements\n", name, vec.size());
+        ++failures;
+    }
+    catch (const stdsc::AbstractException&)
+    {
+    }
+    try
+    {
+        vec = load_from_buffer<T>(data);
+        printf("%s: buffer load accepted %zu elements\n", name, vec.size());
+        ++failures;
+    }
+    catch (const stdsc::AbstractException&)
+    {
+    }
+}
+
+void test_round_trips(void)
+{
+    const std::size_t counts[] = {0, 1, 7, 100000};
+    for (const auto n : counts)
+    {
+        std::vector<int32_t> ints(n);
+        std::vector<uint64_t> u64s(n);
+        std::vector<double> doubles(n);
+        std::vector<std::string> strings(n);
+        std::vector<Point> points(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            ints[i] = static_cast<int32_t>(i * 2654435761u);
+            u64s[i] = std::numeric_limits<uint64_t>::max() - i;
+            doubles[i] = static_cast<double>(i) / 3.0;
+            strings[i] = std::string(i % 13, static_cast<char>(i % 256));
+            points[i] = Point(static_cast<int>(i), -static_cast<int>(i));
+        }
+        test_round_trip("int32", ints);
+        test_round_trip("uint64", u64s);
+        test_round_trip("double", doubles);
+        test_round_trip("string", strings);
+        test_round_trip("Point", points);
+    }
+}
+
+void test_header(void)
+{
+    const auto data = save(std::vector<int32_t>(10, 1));
+
+    expect_refused<int32_t>("empty", std::string());
+    expect_refused<int32_t>("short header", data.substr(0, kElementsOffset - 1));
+
+    auto bad = data;
+    bad[0] = 'X';
+    expect_refused<int32_t>("magic", bad);
+
+    bad = data;
+    set_field<uint16_t>(bad, kVersionOffset, 2);
+    expect_refused<int32_t>("version", bad);
+
+    bad = data;
+    set_field<uint16_t>(bad, kElementSizeOffset, 8);
+    expect_refused<int32_t>("element size", bad);
+
+    /* the element size is checked against the loaded type */
+    expect_refused<int64_t>("int32 as int64", data);
+    expect_refused<std::string>("int32 as string", data);
+}
+
+void test_payload(void)
+{
+    const auto ints = save(std::vector<int32_t>(10, 1));
+    expect_refused<int32_t>("truncated int32", ints.substr(0, ints.size() - 1));
+
+    auto bad = ints;
+    set_field<uint64_t>(bad, kCountOffset, 11);
+    expect_refused<int32_t>("int32 count", bad);
+    set_field<uint64_t>(bad, kCountOffset,
+                        std::numeric_limits<uint64_t>::max());
+    expect_refused<int32_t>("int32 max count", bad);
+    set_field<uint64_t>(bad, kCountOffset,
+                        std::numeric_limits<uint64_t>::max() / 4 + 1);
+    expect_refused<int32_t>("int32 count overflow", bad);
+
+    const std::vector<std::string> vec = {"abc", "", "defgh"};
+    const auto strings = save(vec);
+    expect_refused<std::string>("truncated string",
+                                strings.substr(0, strings.size() - 1));
+    expect_refused<std::string>("truncated length",
+                                strings.substr(0, kElementsOffset + 4));
+
+    bad = strings;
+    set_field<uint64_t>(bad, kCountOffset, 4);
+    expect_refused<std::string>("string count", bad);
+    set_field<uint64_t>(bad, kCountOffset,
+                        std::numeric_limits<uint64_t>::max());
+    expect_refused<std::string>("string max count", bad);
+
+    bad = strings;
+    set_field<uint64_t>(bad, kElementsOffset,
+                        std::numeric_limits<uint64_t>::max());
+    expect_refused<std::string>("string max length", bad);
+
+    /* the text of a Point which does not parse */
+    bad = save(std::vector<Point>(1, Point(1, 2)));
+    bad[bad.size() - 1] = 'z';
+    expect_refused<Point>("Point text", bad);
+}
+
+} /* namespace */
+
+int main(void)
+{
+    test_round_trips();
+    test_header();
+    test_payload();
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_chain.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+/*
+ * Checks that BufferChain frames its segments as documented, that the
+ * framed payload splits back into slices of the same segments, and that
+ * payloads which are not framed exactly are refused.
+ */
+
+namespace
+{
+
+int failures = 0;
+
+void fail(const char* name)
+{
+    printf("%s: failed\n", name);
+    ++failures;
+}
+
+stdsc::Buffer make_segment(const std::size_t size, const uint8_t seed)
+{
+    stdsc::Buffer buffer(size);
+    auto* p = static_cast<uint8_t*>(buffer.data());
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        p[i] = static_cast<uint8_t>(seed + i);
+    }
+    return buffer;
+}
+
+bool same_data(const stdsc::Buffer& a, const stdsc::Buffer& b)
+{
+    return a.size() == b.size() &&
+           std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+stdsc::Buffer make_payload(const std::vector<uint64_t>& words,
+                           const std::size_t extra = 0)
+{
+    stdsc::Buffer buffer(words.size() * sizeof(uint64_t) + extra, 0xaa);
+    std::memcpy(buffer.data(), words.data(), words.size() * sizeof(uint64_t));
+    return buffer;
+}
+
+void expect_refused(const char* name, const stdsc::Buffer& payload)
+{
+    try
+    {
+        stdsc::BufferChain chain(payload);
+        printf("%s: accepted %zu segments\n", name, chain.count());
+        ++failures;
+    }
+    catch (const stdsc::FailureException&)
+    {
+    }
+}
+
+void test_framing(void)
+{
+    /* inline and heap segments, and an empty one */
+    const std::size_t sizes[] = {0, 1, STDSC_BUFFER_INLINE_SIZE,
+                                 STDSC_BUFFER_INLINE_SIZE + 1, 1000};
+    const std::size_t n = sizeof(sizes) / sizeof(sizes[0]);
+
+    stdsc::BufferChain chain;
+    std::vector<stdsc::Buffer> segments;
+    std::size_t payload_size = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        segments.push_back(make_segment(sizes[i], static_cast<uint8_t>(i)));
+        chain.push_back(segments.back());
+        payload_size += sizes[i];
+    }
+
+    const std::size_t header_size = (n + 1) * sizeof(uint64_t);
+    if (chain.count() != n || chain.header_size() != header_size ||
+        chain.size() != header_size + payload_size)
+    {
+        fail("sizes");
+    }
+
+    std::vector<uint64_t> header(n + 1);
+    std::memcpy(header.data(), chain.header(), header_size);
+    if (header[0] != n)
+    {
+        fail("segment count");
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (header[i + 1] != sizes[i] || !same_data(chain.at(i), segments[i]))
+        {
+            fail("segment table");
+        }
+    }
+
+    /* the flattened payload is the header followed by the segments */
+    auto flat = chain.flatten();
+    const auto* p = static_cast<const uint8_t*>(flat.data());
+    if (flat.size() != chain.size() ||
+        std::memcmp(p, chain.header(), header_size) != 0)
+    {
+        fail("flatten header");
+    }
+    std::size_t offset = header_size;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (std::memcmp(p + offset, segments[i].data(), sizes[i]) != 0)
+        {
+            fail("flatten segment");
+        }
+        offset += sizes[i];
+    }
+
+    /* the split segments are slices of the payload */
+    stdsc::BufferChain split(flat);
+    if (split.count() != n || split.size() != flat.size())
+    {
+        fail("split sizes");
+    }
+    for (std::size_t i = 0; i < split.count(); ++i)
+    {
+        if (!split.at(i).is_slice() || !same_data(split.at(i), segments[i]))
+        {
+            fail("split segment");
+        }
+    }
+    static_cast<uint8_t*>(flat.data())[chain.size() - 1] = 0x5a;
+    const auto* last = static_cast<const uint8_t*>(split.at(n - 1).data());
+    if (last[sizes[n - 1] - 1] != 0x5a)
+    {
+        fail("split shares the payload");
+    }
+
+    /* the payload can not be resized under the split segments */
+    try
+    {
+        flat.resize(1);
+        fail("resize under split");
+    }
+    catch (const stdsc::FailureException&)
+    {
+    }
+
+    try
+    {
+        split.at(n);
+        fail("index out of range");
+    }
+    catch (const stdsc::InvParamException&)
+    {
+    }
+
+    chain.clear();
+    if (chain.count() != 0 || chain.size() != sizeof(uint64_t))
+    {
+        fail("clear");
+    }
+}
+
+void test_empty(void)
+{
+    stdsc::BufferChain chain;
+    auto flat = chain.flatten();
+    stdsc::BufferChain split(flat);
+    if (flat.size() != sizeof(uint64_t) || split.count() != 0)
+    {
+        fail("empty chain");
+    }
+}
+
+void test_malformed(void)
+{
+    const uint64_t max = std::numeric_limits<uint64_t>::max();
+
+    expect_refused("empty payload", stdsc::Buffer(0));
+    expect_refused("short count", stdsc::Buffer(sizeof(uint64_t) - 1));
+
+    /* the table does not fit in the payload */
+    expect_refused("count", make_payload({2, 1}));
+    expect_refused("max count", make_payload({max, 1, 1}));
+    expect_refused("count overflow", make_payload({max / 8 + 1, 1}));
+
+    /* the segments do not fit */
+    expect_refused("segment size", make_payload({1, 5}, 4));
+    expect_refused("max segment size", make_payload({2, 1, max}, 1));
+    expect_refused("segment sum", make_payload({2, 3, 3}, 5));
+
+    /* bytes after the last segment */
+    expect_refused("trailing bytes", make_payload({1, 2}, 3));
+    expect_refused("trailing bytes of no segments", make_payload({0}, 1));
+}
+
+} /* namespace */
+
+int main(void)
+{
+    test_framing();
+    test_empty();
+    test_malformed();
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
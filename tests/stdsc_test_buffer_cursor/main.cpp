@@ -0,0 +1,271 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_exception.hpp>
+
+/*
+ * Checks that BufferWriter and BufferReader round-trip fixed-size values
+ * and varints, encode the varints in the expected number of bytes, and
+ * refuse reads beyond the end and malformed varints without moving.
+ */
+
+namespace
+{
+
+int failures = 0;
+
+struct Record
+{
+    uint16_t a;
+    uint64_t b;
+    double c;
+};
+
+template <class T>
+void check_equal(const char* name, const T& actual, const T& expected)
+{
+    if (!(actual == expected))
+    {
+        printf("%s: unexpected value\n", name);
+        ++failures;
+    }
+}
+
+/* Calls func, which must throw E. */
+template <class E, class F>
+void expect_throw(const char* name, F func)
+{
+    try
+    {
+        func();
+        printf("%s: not refused\n", name);
+        ++failures;
+    }
+    catch (const E&)
+    {
+    }
+}
+
+stdsc::Buffer make_buffer(const std::vector<uint8_t>& bytes)
+{
+    stdsc::Buffer buffer(bytes.size());
+    std::memcpy(buffer.data(), bytes.data(), bytes.size());
+    return buffer;
+}
+
+void test_values(void)
+{
+    const Record record = {7, 0x0123456789abcdefULL, -2.5};
+    const char text[] = "payload";
+
+    /* the writer grows an empty buffer, and finish() shrinks it */
+    stdsc::Buffer buffer(0);
+    stdsc::BufferWriter writer(buffer);
+    writer.put<uint8_t>(0xfe);
+    writer.put<int32_t>(-123456);
+    writer.put(record);
+    writer.write(text, sizeof(text));
+    std::memset(writer.claim(3), 0x5a, 3);
+    const auto size = writer.position();
+    writer.finish();
+    check_equal("finished size", buffer.size(), size);
+
+    stdsc::BufferReader reader(buffer);
+    check_equal("uint8", reader.get<uint8_t>(), static_cast<uint8_t>(0xfe));
+    check_equal("int32", reader.get<int32_t>(), -123456);
+    Record r;
+    reader.get(r);
+    check_equal("record", std::memcmp(&r, &record, sizeof(r)), 0);
+    check_equal("peek", std::memcmp(reader.peek(sizeof(text)), text,
+                                    sizeof(text)),
+                0);
+    char out[sizeof(text)];
+    reader.read(out, sizeof(out));
+    check_equal("read", std::memcmp(out, text, sizeof(text)), 0);
+
+    /* the slice shares the data, and outlives the reader */
+    stdsc::Buffer slice = reader.get_slice(3);
+    check_equal("slice size", slice.size(), static_cast<std::size_t>(3));
+    check_equal("slice data", static_cast<const uint8_t*>(slice.data())[2],
+                static_cast<uint8_t>(0x5a));
+    check_equal("remaining", reader.remaining(), static_cast<std::size_t>(0));
+
+    reader.seek(1);
+    check_equal("seek", reader.get<int32_t>(), -123456);
+    check_equal("skip",
+                *static_cast<const uint8_t*>(reader.skip(sizeof(Record))),
+                static_cast<uint8_t>(7));
+
+    /* a writer at an offset keeps the bytes before it */
+    stdsc::Buffer prefixed(4, 0x11);
+    stdsc::BufferWriter appender(prefixed, 2);
+    appender.put<uint32_t>(0xdeadbeef);
+    appender.finish();
+    stdsc::BufferReader check_reader(prefixed);
+    check_equal("prefix", check_reader.get<uint16_t>(),
+                static_cast<uint16_t>(0x1111));
+    check_equal("appended", check_reader.get<uint32_t>(), 0xdeadbeefu);
+}
+
+void test_varints(void)
+{
+    struct Case
+    {
+        uint64_t value;
+        std::size_t size;
+    };
+    const Case cases[] = {
+      {0, 1},
+      {1, 1},
+      {127, 1},
+      {128, 2},
+      {16383, 2},
+      {16384, 3},
+      {0xffffffffULL, 5},
+      {1ULL << 63, 10},
+      {std::numeric_limits<uint64_t>::max(), 10},
+    };
+    for (const auto& c : cases)
+    {
+        stdsc::Buffer buffer(0);
+        stdsc::BufferWriter writer(buffer);
+        writer.put_varint(c.value);
+        writer.finish();
+        stdsc::BufferReader reader(buffer);
+        if (buffer.size() != c.size || reader.get_varint() != c.value ||
+            reader.remaining() != 0)
+        {
+            printf("varint %llu: %zu bytes\n",
+                   static_cast<unsigned long long>(c.value), buffer.size());
+            ++failures;
+        }
+    }
+
+    struct SignedCase
+    {
+        int64_t value;
+        std::size_t size;
+    };
+    const SignedCase signed_cases[] = {
+      {0, 1},
+      {-1, 1},
+      {1, 1},
+      {63, 1},
+      {-64, 1},
+      {64, 2},
+      {-65, 2},
+      {std::numeric_limits<int64_t>::max(), 10},
+      {std::numeric_limits<int64_t>::min(), 10},
+    };
+    for (const auto& c : signed_cases)
+    {
+        stdsc::Buffer buffer(0);
+        stdsc::BufferWriter writer(buffer);
+        writer.put_svarint(c.value);
+        writer.finish();
+        stdsc::BufferReader reader(buffer);
+        if (buffer.size() != c.size || reader.get_svarint() != c.value ||
+            reader.remaining() != 0)
+        {
+            printf("svarint %lld: %zu bytes\n",
+                   static_cast<long long>(c.value), buffer.size());
+            ++failures;
+        }
+    }
+}
+
+void test_bounds(void)
+{
+    auto buffer = make_buffer({1, 2, 3});
+    stdsc::BufferReader reader(buffer, 1);
+
+    using stdsc::FailureException;
+    using stdsc::InvParamException;
+    expect_throw<FailureException>("get", [&] { reader.get<uint32_t>(); });
+    expect_throw<FailureException>("read", [&] {
+        char out[3];
+        reader.read(out, sizeof(out));
+    });
+    expect_throw<FailureException>("peek", [&] { reader.peek(3); });
+    expect_throw<FailureException>("skip", [&] { reader.skip(3); });
+    expect_throw<FailureException>("get_slice", [&] { reader.get_slice(3); });
+    expect_throw<FailureException>("huge read", [&] {
+        reader.skip(std::numeric_limits<std::size_t>::max());
+    });
+    expect_throw<InvParamException>("seek", [&] { reader.seek(4); });
+
+    /* the refused reads do not move the reader */
+    check_equal("position", reader.position(), static_cast<std::size_t>(1));
+    check_equal("in range", reader.get<uint16_t>(),
+                static_cast<uint16_t>(0x0302));
+    expect_throw<FailureException>("get at end",
+                                   [&] { reader.get<uint8_t>(); });
+
+    expect_throw<InvParamException>(
+      "reader offset", [&] { stdsc::BufferReader past(buffer, 4); });
+    expect_throw<InvParamException>(
+      "writer offset", [&] { stdsc::BufferWriter past(buffer, 4); });
+}
+
+void test_malformed_varints(void)
+{
+    using stdsc::FailureException;
+
+    auto truncated = make_buffer({0x80, 0x80});
+    stdsc::BufferReader truncated_reader(truncated);
+    expect_throw<FailureException>("truncated varint",
+                                   [&] { truncated_reader.get_varint(); });
+
+    auto empty = make_buffer({});
+    stdsc::BufferReader empty_reader(empty);
+    expect_throw<FailureException>("empty varint",
+                                   [&] { empty_reader.get_varint(); });
+
+    /* 11 bytes */
+    std::vector<uint8_t> bytes(10, 0x80);
+    bytes.push_back(0);
+    auto too_long = make_buffer(bytes);
+    stdsc::BufferReader long_reader(too_long);
+    expect_throw<FailureException>("long varint",
+                                   [&] { long_reader.get_varint(); });
+
+    /* the 10th byte carries bits beyond 64 */
+    bytes.assign(9, 0xff);
+    bytes.push_back(0x02);
+    auto overflow = make_buffer(bytes);
+    stdsc::BufferReader overflow_reader(overflow);
+    expect_throw<FailureException>("varint overflow",
+                                   [&] { overflow_reader.get_varint(); });
+}
+
+} /* namespace */
+
+int main(void)
+{
+    test_values();
+    test_varints();
+    test_bounds();
+    test_malformed_varints();
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <istream>
+#include <memory>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_callback_function.hpp>
+#include <stdsc/stdsc_callback_function_container.hpp>
+#include <stdsc/stdsc_client.hpp>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_log.hpp>
+#include <stdsc/stdsc_packet.hpp>
+#include <stdsc/stdsc_server.hpp>
+#include <stdsc/stdsc_socket.hpp>
+#include <stdsc/stdsc_state.hpp>
+#include <stdsc/stdsc_stats.hpp>
+
+/*
+ * Checks that the client counts a download rejected by the server in its
+ * first response as a reject, not as a failure.
+ */
+
+namespace
+{
+
+const char* kPort = "23490";
+const uint64_t kCodeDownload = 0x801;
+const uint64_t kCodeUpDownload = 0x1001;
+const uint64_t kCodeAccepted = 0x802;
+const uint64_t kCodeResult = 0x401;
+
+int failures = 0;
+
+DECLARE_DOWNLOAD_CLASS(RejectDownload);
+DEFUN_DOWNLOAD(RejectDownload)
+{
+    STDSC_THROW_CALLBACK("rejected");
+}
+
+DECLARE_UPDOWNLOAD_CLASS(RejectUpDownload);
+DEFUN_UPDOWNLOAD(RejectUpDownload)
+{
+    STDSC_THROW_CALLBACK("rejected");
+}
+
+DECLARE_DOWNLOAD_CLASS(AcceptDownload);
+DEFUN_DOWNLOAD(AcceptDownload)
+{
+    stdsc::Buffer buffer(16);
+    sock.send_packet(stdsc::make_data_packet(kCodeResult,
+                                             buffer.size()));
+    sock.send_buffer(buffer);
+}
+
+struct NopState : public stdsc::State
+{
+    virtual void set(stdsc::StateContext&, uint64_t) override
+    {
+    }
+};
+
+template <class F>
+void expect_reject(const char* name, F func)
+{
+    try
+    {
+        func();
+        printf("%s: not rejected\n", name);
+        ++failures;
+    }
+    catch (const stdsc::RejectException&)
+    {
+    }
+}
+
+void expect_code(const stdsc::ClientStatsSnapshot& snap, const uint64_t code,
+                 const uint64_t requests, const uint64_t rejects)
+{
+    for (const auto& stats : snap.codes)
+    {
+        if (stats.code != code)
+        {
+            continue;
+        }
+        if (stats.requests != requests || stats.rejects != rejects ||
+            stats.failures != 0)
+        {
+            printf("code 0x%llx: requests:%llu rejects:%llu failures:%llu, "
+                   "expected requests:%llu rejects:%llu failures:0\n",
+                   static_cast<unsigned long long>(code),
+                   static_cast<unsigned long long>(stats.requests),
+                   static_cast<unsigned long long>(stats.rejects),
+                   static_cast<unsigned long long>(stats.failures),
+                   static_cast<unsigned long long>(requests),
+                   static_cast<unsigned long long>(rejects));
+            ++failures;
+        }
+        return;
+    }
+    printf("code 0x%llx: not recorded\n",
+           static_cast<unsigned long long>(code));
+    ++failures;
+}
+
+} /* namespace */
+
+int main(void)
+{
+    STDSC_INIT_LOG();
+    STDSC_SET_LOG_LEVEL(stdsc::kLogLevelErr);
+
+    stdsc::StateContext state(std::make_shared<NopState>());
+    stdsc::CallbackFunctionContainer callback;
+    std::shared_ptr<stdsc::CallbackFunction> download(new RejectDownload);
+    std::shared_ptr<stdsc::CallbackFunction> updownload(new RejectUpDownload);
+    std::shared_ptr<stdsc::CallbackFunction> accepted(new AcceptDownload);
+    callback.set(kCodeDownload, download);
+    callback.set(kCodeUpDownload, updownload);
+    callback.set(kCodeAccepted, accepted);
+
+    stdsc::Server<> server(kPort, state, callback);
+    server.start(true);
+
+    {
+        stdsc::Client client;
+        client.connect("localhost", kPort);
+
+        stdsc::Buffer rbuffer;
+        expect_reject("recv_data", [&] {
+            client.recv_data(kCodeDownload, rbuffer);
+        });
+        expect_reject("recv_stream", [&] {
+            client.recv_stream(kCodeDownload, [](std::istream&) {});
+        });
+        stdsc::Buffer sbuffer(16);
+        expect_reject("send_recv_data", [&] {
+            client.send_recv_data(kCodeUpDownload, sbuffer, rbuffer);
+        });
+        client.recv_data(kCodeAccepted, rbuffer);
+
+        auto snap = client.stats()->snapshot();
+        expect_code(snap, kCodeDownload, 2, 2);
+        expect_code(snap, kCodeUpDownload, 1, 1);
+        expect_code(snap, kCodeAccepted, 1, 0);
+        client.close();
+    }
+
+    server.stop();
+    {
+        /* wakes the server up from accept() to see the stop */
+        stdsc::Client client;
+        client.connect("localhost", kPort);
+        client.close();
+    }
+    server.wait();
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
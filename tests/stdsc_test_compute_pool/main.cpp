@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <stdsc/stdsc_compute_pool.hpp>
+
+/*
+ * Checks that parallel_for and parallel_reduce split [begin, end) into
+ * non-empty subranges which cover it exactly, also for ranges that are
+ * not a multiple of the number of chunks or are shorter than the pool,
+ * and that every subrange but the last has at least `grain` elements.
+ */
+
+namespace
+{
+
+using Range = std::pair<std::size_t, std::size_t>;
+
+int failures = 0;
+
+/* `ranges` must be sorted. */
+void check(const char* name, const std::size_t threads,
+           const std::size_t begin, const std::size_t end,
+           const std::size_t grain, const std::vector<Range>& ranges)
+{
+    std::size_t pos = begin;
+    for (const auto& r : ranges)
+    {
+        if (r.second < end && r.second - r.first < grain)
+        {
+            printf("%s threads:%zu [%zu,%zu) grain:%zu: short range [%zu,%zu)"
+                   "\n",
+                   name, threads, begin, end, grain, r.first, r.second);
+            ++failures;
+            return;
+        }
+        if (r.first != pos || r.second <= r.first || end < r.second)
+        {
+            printf("%s threads:%zu [%zu,%zu) grain:%zu: bad range [%zu,%zu) "
+                   "at %zu\n",
+                   name, threads, begin, end, grain, r.first, r.second, pos);
+            ++failures;
+            return;
+        }
+        pos = r.second;
+    }
+    if (pos != end)
+    {
+        printf("%s threads:%zu [%zu,%zu) grain:%zu: covered up to %zu\n", name,
+               threads, begin, end, grain, pos);
+        ++failures;
+    }
+}
+
+void test_parallel_for(stdsc::ComputePool& pool, const std::size_t begin,
+                       const std::size_t end, const std::size_t grain)
+{
+    std::mutex mutex;
+    std::vector<Range> ranges;
+    pool.parallel_for(
+      begin, end,
+      [&](std::size_t first, std::size_t last) {
+          std::lock_guard<std::mutex> lock(mutex);
+          ranges.emplace_back(first, last);
+      },
+      grain);
+    std::sort(ranges.begin(), ranges.end());
+    check("parallel_for", pool.size(), begin, end, grain, ranges);
+}
+
+void test_parallel_reduce(stdsc::ComputePool& pool, const std::size_t begin,
+                          const std::size_t end, const std::size_t grain)
+{
+    /* the ranges are concatenated in the order of reduction */
+    auto ranges = pool.parallel_reduce(
+      begin, end, std::vector<Range>(),
+      [](std::size_t first, std::size_t last) {
+          return std::vector<Range>(1, Range(first, last));
+      },
+      [](std::vector<Range> a, const std::vector<Range>& b) {
+          a.insert(a.end(), b.begin(), b.end());
+          return a;
+      },
+      grain);
+    check("parallel_reduce", pool.size(), begin, end, grain, ranges);
+}
+
+} /* namespace */
+
+int main(void)
+{
+    const std::size_t threads[] = {1, 2, 3, 8};
+    const std::size_t counts[] = {0, 1, 2, 3, 5, 7, 9, 31, 33, 100, 129, 1000};
+    const std::size_t grains[] = {1, 4, 50};
+    const std::size_t begin = 10;
+
+    for (const auto nthreads : threads)
+    {
+        stdsc::ComputePool pool(nthreads);
+        for (const auto n : counts)
+        {
+            for (const auto grain : grains)
+            {
+                test_parallel_for(pool, begin, begin + n, grain);
+                test_parallel_reduce(pool, begin, begin + n, grain);
+            }
+        }
+    }
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
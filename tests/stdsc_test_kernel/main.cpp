@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include <stdsc/stdsc_kernel.hpp>
+
+/*
+ * Compares the modular kernels of each instruction set supported by the
+ * CPU with the scalar ones and with wide arithmetic, for moduli up to
+ * 2^bits - 1.
+ */
+
+namespace
+{
+
+using stdsc::kernel::add_mod;
+using stdsc::kernel::sub_mod;
+using stdsc::kernel::mod_reduce;
+
+/* not a multiple of the lanes, so that the scalar tail runs too */
+const std::size_t kCount = 1003;
+
+int failures = 0;
+
+template <class T>
+struct Wide;
+
+template <>
+struct Wide<uint32_t>
+{
+    using type = uint64_t;
+};
+
+template <>
+struct Wide<uint64_t>
+{
+    using type = unsigned __int128;
+};
+
+template <class T>
+T expected_add(const T a, const T b, const T m)
+{
+    using W = typename Wide<T>::type;
+    return static_cast<T>((static_cast<W>(a) + b) % m);
+}
+
+template <class T>
+T expected_sub(const T a, const T b, const T m)
+{
+    using W = typename Wide<T>::type;
+    return static_cast<T>((static_cast<W>(a) + m - b) % m);
+}
+
+template <class T>
+void check(const char* kernel, const stdsc::KernelIsa_t isa, const T m,
+           const std::vector<T>& a, const std::vector<T>& b,
+           const std::vector<T>& out, const std::vector<T>& expected)
+{
+    for (std::size_t i = 0; i < out.size(); ++i)
+    {
+        if (out[i] != expected[i])
+        {
+            printf("%s isa:%d bits:%zu m:0x%llx i:%zu a:0x%llx b:0x%llx "
+                   "got:0x%llx expected:0x%llx\n",
+                   kernel, isa, sizeof(T) * 8,
+                   static_cast<unsigned long long>(m), i,
+                   static_cast<unsigned long long>(a[i]),
+                   static_cast<unsigned long long>(b[i]),
+                   static_cast<unsigned long long>(out[i]),
+                   static_cast<unsigned long long>(expected[i]));
+            ++failures;
+            return;
+        }
+    }
+}
+
+/* Random values less than `limit`, with the edge values in front. */
+template <class T>
+std::vector<T> make_input(std::mt19937_64& rng, const T limit)
+{
+    std::vector<T> v = {0, 1, static_cast<T>(limit - 1), static_cast<T>(limit / 2)};
+    std::uniform_int_distribution<T> dist(0, limit - 1);
+    while (v.size() < kCount)
+    {
+        v.push_back(dist(rng));
+    }
+    return v;
+}
+
+template <class T>
+void test_modulus(std::mt19937_64& rng, const T m)
+{
+    const auto a = make_input<T>(rng, m);
+    auto b = make_input<T>(rng, m);
+    std::reverse(b.begin(), b.begin() + 4);
+
+    std::vector<T> add(kCount), sub(kCount), reduce_in(kCount), reduce(kCount);
+    for (std::size_t i = 0; i < kCount; ++i)
+    {
+        add[i] = expected_add(a[i], b[i], m);
+        sub[i] = expected_sub(a[i], b[i], m);
+        /* values less than 2m, which do not wrap around */
+        reduce_in[i] = a[i] <= std::numeric_limits<T>::max() - m
+                         ? static_cast<T>(a[i] + (b[i] & 1 ? m : 0))
+                         : a[i];
+        reduce[i] = static_cast<T>(reduce_in[i] % m);
+    }
+
+    const T half = static_cast<T>(T(1) << (sizeof(T) * 8 - 1));
+    const auto best = stdsc::kernel::detected_isa();
+    std::vector<T> out(kCount);
+    for (int i = stdsc::kKernelIsaScalar; i <= best; ++i)
+    {
+        const auto isa = static_cast<stdsc::KernelIsa_t>(i);
+        stdsc::kernel::set_isa(isa);
+        if (m <= half)
+        {
+            add_mod(a.data(), b.data(), out.data(), kCount, m);
+            check("add_mod", isa, m, a, b, out, add);
+        }
+        sub_mod(a.data(), b.data(), out.data(), kCount, m);
+        check("sub_mod", isa, m, a, b, out, sub);
+        mod_reduce(reduce_in.data(), out.data(), kCount, m);
+        check("mod_reduce", isa, m, reduce_in, reduce_in, out, reduce);
+    }
+    stdsc::kernel::set_isa(best);
+}
+
+template <class T>
+void test_type(std::mt19937_64& rng)
+{
+    const T max = std::numeric_limits<T>::max();
+    const T half = static_cast<T>(T(1) << (sizeof(T) * 8 - 1));
+    const T moduli[] = {
+      2, 17, static_cast<T>(half - 1), half, static_cast<T>(half + 1),
+      static_cast<T>(max - 58), static_cast<T>(max - 1), max};
+    for (const auto m : moduli)
+    {
+        test_modulus<T>(rng, m);
+    }
+}
+
+} /* namespace */
+
+int main(void)
+{
+    std::mt19937_64 rng(20181018);
+    printf("detected isa: %d\n", stdsc::kernel::detected_isa());
+    test_type<uint32_t>(rng);
+    test_type<uint64_t>(rng);
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,303 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdsc/stdsc_buffer.hpp>
+#include <stdsc/stdsc_buffer_cursor.hpp>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_parallel_codec.hpp>
+
+/*
+ * Round-trips vectors through the stream and the buffer paths of
+ * ParallelCodec, and checks that truncated data, oversized segment counts,
+ * corrupted segment tables and segments with trailing bytes are refused.
+ */
+
+namespace
+{
+
+/* the offsets of the fields in the saved data */
+const std::size_t kElementCountOffset = 8;
+const std::size_t kSegmentCountOffset = 16;
+const std::size_t kTableOffset = sizeof(stdsc::ParallelHeader);
+const std::size_t kIndexOffset = 0;
+const std::size_t kFirstOffset = 8;
+const std::size_t kCountOffset = 16;
+const std::size_t kSizeOffset = 24;
+
+int failures = 0;
+
+template <class T>
+std::string save(const std::vector<T>& vec)
+{
+    std::ostringstream oss;
+    stdsc::ParallelCodec<T>::save(oss, vec);
+    return oss.str();
+}
+
+template <class T>
+std::string save_to_buffer(const std::vector<T>& vec)
+{
+    stdsc::Buffer buffer(0);
+    stdsc::BufferWriter writer(buffer);
+    stdsc::ParallelCodec<T>::save(writer, vec);
+    writer.finish();
+    return std::string(static_cast<const char*>(buffer.data()), buffer.size());
+}
+
+template <class T>
+std::vector<T> load(const std::string& data)
+{
+    std::istringstream iss(data);
+    std::vector<T> vec;
+    stdsc::ParallelCodec<T>::load(iss, vec);
+    return vec;
+}
+
+/* The reader must end at the end of the data. */
+template <class T>
+std::vector<T> load_from_buffer(const std::string& data)
+{
+    stdsc::Buffer buffer(data.size());
+    std::memcpy(buffer.data(), data.data(), data.size());
+    stdsc::BufferReader reader(buffer);
+    std::vector<T> vec;
+    stdsc::ParallelCodec<T>::load(reader, vec);
+    if (reader.remaining() != 0)
+    {
+        printf("load_from_buffer: %zu bytes left\n", reader.remaining());
+        ++failures;
+    }
+    return vec;
+}
+
+uint64_t get_field(const std::string& data, const std::size_t offset)
+{
+    uint64_t v;
+    std::memcpy(&v, &data[offset], sizeof(v));
+    return v;
+}
+
+void set_field(std::string& data, const std::size_t offset, const uint64_t v)
+{
+    std::memcpy(&data[offset], &v, sizeof(v));
+}
+
+std::size_t segment_offset(const std::size_t i, const std::size_t field)
+{
+    return kTableOffset + i * sizeof(stdsc::ParallelSegment) + field;
+}
+
+template <class T>
+void test_round_trip(const char* name, const std::vector<T>& vec)
+{
+    const auto data = save(vec);
+    if (save_to_buffer(vec) != data)
+    {
+        printf("%s n:%zu: stream and buffer outputs differ\n", name,
+               vec.size());
+        ++failures;
+    }
+    if (stdsc::ParallelCodec<T>::stream_size(vec) != data.size())
+    {
+        printf("%s n:%zu: stream_size %zu != %zu\n", name, vec.size(),
+               stdsc::ParallelCodec<T>::stream_size(vec), data.size());
+        ++failures;
+    }
+    if (load<T>(data) != vec || load_from_buffer<T>(data) != vec)
+    {
+        printf("%s n:%zu: round trip failed\n", name, vec.size());
+        ++failures;
+    }
+}
+
+template <class T>
+void expect_refused(const char* name, const std::string& data)
+{
+    std::vector<T> vec;
+    try
+    {
+        vec = load<T>(data);
+        printf("%s: stream load accepted %zu elements\n", name, vec.size());
+        ++failures;
+    }
+    catch (const stdsc::AbstractException&)
+    {
+    }
+    try
+    {
+        vec = load_from_buffer<T>(data);
+        printf("%s: buffer load accepted %zu elements\n", name, vec.size());
+        ++failures;
+    }
+    catch (const stdsc::AbstractException&)
+    {
+    }
+}
+
+std::vector<int32_t> make_ints(const std::size_t n)
+{
+    std::vector<int32_t> vec(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        vec[i] = static_cast<int32_t>(i * 2654435761u);
+    }
+    return vec;
+}
+
+std::vector<std::string> make_strings(const std::size_t n)
+{
+    std::vector<std::string> vec(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        vec[i] = std::string(i % 7, static_cast<char>('a' + i % 26));
+    }
+    return vec;
+}
+
+void test_round_trips(void)
+{
+    /* several segments from STDSC_PARALLEL_SEGMENT_MIN_COUNT * 2 */
+    const std::size_t counts[] = {0, 1, 1000,
+                                  STDSC_PARALLEL_SEGMENT_MIN_COUNT * 2 + 5};
+    for (const auto n : counts)
+    {
+        test_round_trip("int32", make_ints(n));
+        test_round_trip("string", make_strings(n));
+
+        std::vector<double> doubles(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            doubles[i] = static_cast<double>(i) / 3.0;
+        }
+        test_round_trip("double", doubles);
+    }
+}
+
+void test_truncated(void)
+{
+    const auto ints = save(make_ints(1000));
+    const auto strings = save(make_strings(1000));
+    const std::size_t sizes[] = {0, 1, kTableOffset - 1, kTableOffset,
+                                 kTableOffset + 8};
+    for (const auto size : sizes)
+    {
+        expect_refused<int32_t>("truncated int32 table", ints.substr(0, size));
+        expect_refused<std::string>("truncated string table",
+                                    strings.substr(0, size));
+    }
+    expect_refused<int32_t>("truncated int32 payload",
+                            ints.substr(0, ints.size() - 1));
+    expect_refused<std::string>("truncated string payload",
+                                strings.substr(0, strings.size() - 1));
+}
+
+void test_segment_count(void)
+{
+    const auto data = save(make_ints(1000));
+    const uint64_t segment_counts[] = {
+      0, 2, 1000 + 2, std::numeric_limits<uint64_t>::max(),
+      std::numeric_limits<uint64_t>::max() / sizeof(stdsc::ParallelSegment)};
+    for (const auto segment_count : segment_counts)
+    {
+        auto bad = data;
+        set_field(bad, kSegmentCountOffset, segment_count);
+        expect_refused<int32_t>("segment count", bad);
+    }
+
+    /* the element count is also at its maximum */
+    auto bad = data;
+    set_field(bad, kElementCountOffset, std::numeric_limits<uint64_t>::max());
+    set_field(bad, kSegmentCountOffset, std::numeric_limits<uint64_t>::max());
+    expect_refused<int32_t>("segment count of max elements", bad);
+}
+
+void test_segment_table(void)
+{
+    const auto data = save(make_ints(STDSC_PARALLEL_SEGMENT_MIN_COUNT * 2 + 5));
+    /* a single segment if the pool has a single thread */
+    const auto nsegs = get_field(data, kSegmentCountOffset);
+
+    struct Corruption
+    {
+        const char* name;
+        std::size_t field;
+        int64_t delta;
+    };
+    const Corruption corruptions[] = {
+      {"index", kIndexOffset, 1},
+      {"first", kFirstOffset, 1},
+      {"count", kCountOffset, 1},
+      {"count", kCountOffset, -1},
+      {"size", kSizeOffset, 1},
+      {"size", kSizeOffset, -4},
+    };
+    for (std::size_t i = 0; i < nsegs; ++i)
+    {
+        for (const auto& c : corruptions)
+        {
+            auto bad = data;
+            const auto offset = segment_offset(i, c.field);
+            set_field(bad, offset, get_field(bad, offset) + c.delta);
+            expect_refused<int32_t>(c.name, bad);
+        }
+    }
+
+    auto bad = data;
+    set_field(bad, segment_offset(0, kCountOffset),
+              std::numeric_limits<uint64_t>::max());
+    expect_refused<int32_t>("count overflow", bad);
+    bad = data;
+    set_field(bad, segment_offset(0, kSizeOffset),
+              std::numeric_limits<uint64_t>::max());
+    expect_refused<int32_t>("size overflow", bad);
+}
+
+/* A segment of variable-length elements with a byte left after its
+ * elements. */
+void test_trailing_bytes(void)
+{
+    auto data = save(make_strings(10));
+    const auto offset = segment_offset(0, kSizeOffset);
+    set_field(data, offset, get_field(data, offset) + 1);
+    data.push_back('x');
+    expect_refused<std::string>("trailing bytes", data);
+
+    /* a shorter segment cuts the last element */
+    data = save(make_strings(10));
+    set_field(data, offset, get_field(data, offset) - 1);
+    data.pop_back();
+    expect_refused<std::string>("short segment", data);
+}
+
+} /* namespace */
+
+int main(void)
+{
+    test_round_trips();
+    test_truncated();
+    test_segment_count();
+    test_segment_table();
+    test_trailing_bytes();
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_text_codec.hpp>
+
+/*
+ * Checks that TextCodec writes exactly what operator<< writes, reads the
+ * same values as operator>> (strtod where operator>> refuses the value,
+ * e.g. inf and nan), and round-trips at max_digits10. The boundary values
+ * are tested along with random bit patterns.
+ */
+
+namespace
+{
+
+int failures = 0;
+
+template <class T>
+std::string to_hex(const T v)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &v, sizeof(v));
+    char buf[32];
+    snprintf(buf, sizeof(buf), "0x%llx", static_cast<unsigned long long>(bits));
+    return buf;
+}
+
+template <class T>
+bool same(const T a, const T b)
+{
+    if (std::isnan(a) || std::isnan(b))
+    {
+        return std::isnan(a) && std::isnan(b);
+    }
+    return memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+void fail(const std::string& message)
+{
+    if (failures++ < 20)
+    {
+        printf("%s\n", message.c_str());
+    }
+}
+
+template <class T>
+std::string reference_text(const std::vector<T>& vec, const int precision)
+{
+    std::ostringstream os;
+    os.precision(precision);
+    os << vec.size() << '\n';
+    for (const auto& v : vec)
+    {
+        os << v << '\n';
+    }
+    return os.str();
+}
+
+template <class T>
+T reference_value(const std::string& token)
+{
+    std::istringstream is(token);
+    T v;
+    if (is >> v)
+    {
+        return v;
+    }
+    return static_cast<T>(std::is_same<T, float>::value
+                            ? strtof(token.c_str(), nullptr)
+                            : strtod(token.c_str(), nullptr));
+}
+
+template <class T>
+std::vector<T> floating_values(std::mt19937_64& rng)
+{
+    using L = std::numeric_limits<T>;
+    std::vector<T> v = {
+      0, -T(0), L::min(), -L::min(), L::denorm_min(), -L::denorm_min(),
+      L::min() - L::denorm_min(), L::max(), -L::max(), L::lowest(),
+      L::infinity(), -L::infinity(), L::quiet_NaN(), L::epsilon(),
+      T(1), T(-1), T(0.1), T(1) / 3, T(2) / 3, T(0.5), T(1.5), T(2.5),
+      T(123456789), T(1e-5), T(1e-4), T(9.9999995e-5), T(1e16), T(1e17),
+      T(1e22), T(1e23), T(0.30000000000000004), T(5e-324),
+      T(2.2250738585072009e-308), T(1.7976931348623157e308)};
+    std::uniform_int_distribution<uint64_t> dist;
+    for (int i = 0; i < 20000; ++i)
+    {
+        uint64_t bits = dist(rng);
+        T x;
+        memcpy(&x, &bits, sizeof(x));
+        v.push_back(x);
+    }
+    /* decimal values of every magnitude, which hit the exact paths */
+    std::uniform_int_distribution<int> exp(-40, 40);
+    std::uniform_int_distribution<uint64_t> sig(0, 99999999999999999ULL);
+    for (int i = 0; i < 20000; ++i)
+    {
+        v.push_back(static_cast<T>(static_cast<double>(sig(rng)) *
+                                   std::pow(10.0, exp(rng) - 16)));
+    }
+    return v;
+}
+
+template <class T>
+void test_floating(const char* name, std::mt19937_64& rng)
+{
+    const auto values = floating_values<T>(rng);
+    const int precisions[] = {0, 1, 6, 9, std::numeric_limits<T>::digits10,
+                              std::numeric_limits<T>::max_digits10};
+    for (const auto precision : precisions)
+    {
+        std::ostringstream os;
+        os.precision(precision);
+        stdsc::TextCodec<T>::save(os, values);
+        const auto expected = reference_text(values, precision);
+        if (os.str() != expected)
+        {
+            std::istringstream got(os.str()), ref(expected);
+            std::string g, r;
+            for (std::size_t i = 0; std::getline(got, g) && std::getline(ref, r);
+                 ++i)
+            {
+                if (g != r)
+                {
+                    fail(std::string(name) + " save precision " +
+                         std::to_string(precision) + ": got \"" + g +
+                         "\" expected \"" + r + "\"");
+                    break;
+                }
+            }
+        }
+
+        std::istringstream is(expected);
+        std::vector<T> loaded;
+        stdsc::TextCodec<T>::load(is, loaded);
+        std::istringstream tokens(expected);
+        std::string token;
+        tokens >> token;
+        for (std::size_t i = 0; i < loaded.size() && tokens >> token; ++i)
+        {
+            const T ref = reference_value<T>(token);
+            if (!same(loaded[i], ref))
+            {
+                fail(std::string(name) + " load \"" + token + "\": got " +
+                     to_hex(loaded[i]) + " expected " + to_hex(ref));
+            }
+        }
+        if (loaded.size() != values.size())
+        {
+            fail(std::string(name) + " load: wrong count");
+        }
+
+        if (precision == std::numeric_limits<T>::max_digits10)
+        {
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                if (!same(values[i], loaded[i]))
+                {
+                    fail(std::string(name) + " round trip: " +
+                         to_hex(values[i]) + " became " + to_hex(loaded[i]));
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+void test_integer(const char* name, std::mt19937_64& rng)
+{
+    using L = std::numeric_limits<T>;
+    std::vector<T> values = {0, 1, T(-1), L::min(), L::max(),
+                             static_cast<T>(L::min() + 1),
+                             static_cast<T>(L::max() - 1), 9, 10, 99, 100};
+    std::uniform_int_distribution<uint64_t> dist;
+    for (int i = 0; i < 10000; ++i)
+    {
+        values.push_back(static_cast<T>(dist(rng) >> (i % 64)));
+    }
+
+    std::ostringstream os;
+    stdsc::TextCodec<T>::save(os, values);
+    if (os.str() != reference_text(values, 6))
+    {
+        fail(std::string(name) + " save differs from operator<<");
+    }
+    std::istringstream is(os.str());
+    std::vector<T> loaded;
+    stdsc::TextCodec<T>::load(is, loaded);
+    if (loaded != values)
+    {
+        fail(std::string(name) + " round trip differs");
+    }
+
+    /* one past the limits must be refused, as operator>> does */
+    const std::string max = std::to_string(L::max());
+    std::string over = max;
+    ++over.back();
+    const std::string inputs[] = {"1\n" + over + "\n", "1\n1x\n", "1\n-\n"};
+    for (const auto& input : inputs)
+    {
+        std::istringstream bad(input);
+        try
+        {
+            stdsc::TextCodec<T>::load(bad, loaded);
+            fail(std::string(name) + " accepted \"" + input + "\"");
+        }
+        catch (const stdsc::FailureException&)
+        {
+        }
+    }
+}
+
+/* A streambuf which can not seek, like a socket. */
+class PipeBuf : public std::streambuf
+{
+public:
+    explicit PipeBuf(const std::string& data) : data_(data), pos_(0)
+    {
+    }
+
+protected:
+    int_type underflow(void) override
+    {
+        if (data_.size() <= pos_)
+        {
+            return traits_type::eof();
+        }
+        const std::size_t n = std::min<std::size_t>(3, data_.size() - pos_);
+        setg(&data_[pos_], &data_[pos_], &data_[pos_] + n);
+        pos_ += n;
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::string data_;
+    std::size_t pos_;
+};
+
+void test_following_bytes(void)
+{
+    const std::vector<int64_t> values = {1, -22, 333};
+    std::ostringstream os;
+    stdsc::TextCodec<int64_t>::save(os, values);
+    const std::string data = os.str() + "tail";
+
+    PipeBuf pipe(data);
+    std::stringbuf seekable(data);
+    std::streambuf* bufs[] = {&pipe, &seekable};
+    for (auto* sb : bufs)
+    {
+        std::istream is(sb);
+        std::vector<int64_t> loaded;
+        stdsc::TextCodec<int64_t>::load(is, loaded);
+        std::string rest;
+        is >> rest;
+        if (loaded != values || rest != "tail")
+        {
+            fail("bytes following the elements are lost: \"" + rest + "\"");
+        }
+    }
+}
+
+} /* namespace */
+
+int main(void)
+{
+    std::mt19937_64 rng(20181018);
+    test_floating<double>("double", rng);
+    test_floating<float>("float", rng);
+    test_integer<int64_t>("int64", rng);
+    test_integer<uint64_t>("uint64", rng);
+    test_integer<int32_t>("int32", rng);
+    test_following_bytes();
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
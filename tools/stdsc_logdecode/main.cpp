@@ -0,0 +1,396 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stdsc/stdsc_log_binary.hpp>
+
+/*
+ * Decodes the binary log written by stdsc::Logger::enable_binary()
+ * into the same lines as the text log.
+ *   usage: stdsc_logdecode [-t] <file>
+ *     -t : prefix each line with the time of the message
+ */
+
+namespace
+{
+
+struct Site
+{
+    uint32_t level;
+    uint32_t line;
+    std::string file;
+    std::string func;
+    std::string format;
+};
+
+struct Arg
+{
+    uint8_t type;
+    int64_t i;
+    uint64_t u;
+    double d;
+    std::string s;
+};
+
+class Reader
+{
+public:
+    Reader(const std::vector<char>& buf) : buf_(buf), pos_(0)
+    {
+    }
+
+    bool eof(void) const
+    {
+        return buf_.size() <= pos_;
+    }
+
+    template <class T>
+    T get(void)
+    {
+        T v;
+        check(sizeof(T));
+        memcpy(&v, buf_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return v;
+    }
+
+    std::string get_string(const std::size_t len)
+    {
+        check(len);
+        std::string s(buf_.data() + pos_, len);
+        pos_ += len;
+        return s;
+    }
+
+    std::string get_string(void)
+    {
+        return get_string(get<uint16_t>());
+    }
+
+private:
+    void check(const std::size_t len) const
+    {
+        if (buf_.size() < pos_ + len)
+        {
+            throw std::runtime_error("truncated log");
+        }
+    }
+
+    const std::vector<char>& buf_;
+    std::size_t pos_;
+};
+
+std::vector<Arg> decode_args(const std::string& data)
+{
+    std::vector<char> buf(data.begin(), data.end());
+    Reader reader(buf);
+    std::vector<Arg> args;
+    while (!reader.eof())
+    {
+        Arg arg = Arg();
+        arg.type = reader.get<uint8_t>();
+        switch (arg.type)
+        {
+            case stdsc::kLogArgSigned:
+                arg.i = reader.get<int64_t>();
+                arg.u = static_cast<uint64_t>(arg.i);
+                arg.d = static_cast<double>(arg.i);
+                break;
+            case stdsc::kLogArgUnsigned:
+            case stdsc::kLogArgPointer:
+                arg.u = reader.get<uint64_t>();
+                arg.i = static_cast<int64_t>(arg.u);
+                arg.d = static_cast<double>(arg.u);
+                break;
+            case stdsc::kLogArgDouble:
+                arg.d = reader.get<double>();
+                arg.i = static_cast<int64_t>(arg.d);
+                arg.u = static_cast<uint64_t>(arg.i);
+                break;
+            case stdsc::kLogArgString:
+                arg.s = reader.get_string();
+                break;
+            default:
+                throw std::runtime_error("unknown argument type");
+        }
+        args.push_back(arg);
+    }
+    return args;
+}
+
+/* Formats the message like printf(), taking the arguments in order. The
+ * length modifiers of the format are replaced by the type of the argument. */
+std::string format_message(const std::string& format,
+                           const std::vector<Arg>& args)
+{
+    static const Arg missing = Arg();
+    std::size_t next = 0;
+    auto take = [&](void) -> const Arg& {
+        return next < args.size() ? args[next++] : missing;
+    };
+
+    std::string out;
+    char tmp[1024];
+    for (std::size_t i = 0; i < format.size(); ++i)
+    {
+        if (format[i] != '%')
+        {
+            out += format[i];
+            continue;
+        }
+        if (i + 1 < format.size() && format[i + 1] == '%')
+        {
+            out += '%';
+            ++i;
+            continue;
+        }
+
+        std::string spec("%");
+        std::size_t j = i + 1;
+        while (j < format.size() && strchr("-+ #0", format[j]))
+        {
+            spec += format[j++];
+        }
+        for (int part = 0; part < 2; ++part)
+        {
+            if (part == 1)
+            {
+                if (j >= format.size() || format[j] != '.')
+                {
+                    break;
+                }
+                spec += format[j++];
+            }
+            if (j < format.size() && format[j] == '*')
+            {
+                spec += std::to_string(take().i);
+                ++j;
+            }
+            while (j < format.size() && '0' <= format[j] && format[j] <= '9')
+            {
+                spec += format[j++];
+            }
+        }
+        while (j < format.size() && strchr("hljztLq", format[j]))
+        {
+            ++j;
+        }
+        if (j >= format.size())
+        {
+            out += format.substr(i);
+            break;
+        }
+
+        const char conv = format[j];
+        const Arg& arg = take();
+        int n = 0;
+        switch (conv)
+        {
+            case 'd':
+            case 'i':
+                n = snprintf(tmp, sizeof(tmp), (spec + "ll" + conv).c_str(),
+                             static_cast<long long>(arg.i));
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+                if (conv == 'c')
+                {
+                    n = snprintf(tmp, sizeof(tmp), (spec + conv).c_str(),
+                                 static_cast<int>(arg.i));
+                }
+                else
+                {
+                    n = snprintf(tmp, sizeof(tmp), (spec + "ll" + conv).c_str(),
+                                 static_cast<unsigned long long>(arg.u));
+                }
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                n = snprintf(tmp, sizeof(tmp), (spec + conv).c_str(), arg.d);
+                break;
+            case 's':
+                n = snprintf(tmp, sizeof(tmp), (spec + conv).c_str(),
+                             arg.s.c_str());
+                break;
+            case 'p':
+                n = snprintf(tmp, sizeof(tmp), (spec + conv).c_str(),
+                             reinterpret_cast<void*>(
+                               static_cast<uintptr_t>(arg.u)));
+                break;
+            default:
+                n = snprintf(tmp, sizeof(tmp), "%s",
+                             format.substr(i, j - i + 1).c_str());
+                break;
+        }
+        if (0 < n)
+        {
+            out.append(tmp, std::min<std::size_t>(n, sizeof(tmp) - 1));
+        }
+        i = j;
+    }
+    return out;
+}
+
+std::string make_debuginfo(const Site& site)
+{
+    std::string file = site.file;
+    file.erase(0, file.find_last_of("/") + 1);
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%-24s %5u %-32s ", file.c_str(), site.line,
+             site.func.c_str());
+    return tmp;
+}
+
+std::string make_time(const uint64_t ns)
+{
+    time_t sec = static_cast<time_t>(ns / 1000000000);
+    struct tm tm;
+    localtime_r(&sec, &tm);
+    char tmp[64];
+    std::size_t n = strftime(tmp, sizeof(tmp), "%Y-%m-%d %H:%M:%S", &tm);
+    snprintf(tmp + n, sizeof(tmp) - n, ".%09llu ",
+             static_cast<unsigned long long>(ns % 1000000000));
+    return tmp;
+}
+
+void decode(const std::vector<char>& buf, const bool show_time)
+{
+    Reader reader(buf);
+    if (reader.get<uint32_t>() != stdsc::STDSC_LOG_BINARY_MAGIC)
+    {
+        throw std::runtime_error("not a binary log");
+    }
+    if (reader.get<uint16_t>() != stdsc::STDSC_LOG_BINARY_VERSION)
+    {
+        throw std::runtime_error("unsupported version");
+    }
+    reader.get<uint16_t>();
+
+    std::map<uint32_t, Site> sites;
+    while (!reader.eof())
+    {
+        const uint8_t type = reader.get<uint8_t>();
+        if (type == stdsc::kLogFrameSite)
+        {
+            const uint32_t id = reader.get<uint32_t>();
+            Site& site = sites[id];
+            site.level = reader.get<uint32_t>();
+            site.line = reader.get<uint32_t>();
+            site.file = reader.get_string();
+            site.func = reader.get_string();
+            site.format = reader.get_string();
+        }
+        else if (type == stdsc::kLogFrameMessage)
+        {
+            const uint32_t id = reader.get<uint32_t>();
+            const bool debuginfo = reader.get<uint8_t>() != 0;
+            const uint64_t ns = reader.get<uint64_t>();
+            const std::string data = reader.get_string();
+            auto it = sites.find(id);
+            if (it == sites.end())
+            {
+                throw std::runtime_error("unknown site " + std::to_string(id));
+            }
+            std::string line = format_message(it->second.format,
+                                              decode_args(data));
+            if (line.size() < 48)
+            {
+                line.append(48 - line.size(), ' ');
+            }
+            if (debuginfo)
+            {
+                line += make_debuginfo(it->second);
+            }
+            std::cout << (show_time ? make_time(ns) : "") << line << "\n";
+        }
+        else if (type == stdsc::kLogFrameText)
+        {
+            std::cout << reader.get_string() << "\n";
+        }
+        else
+        {
+            throw std::runtime_error("unknown frame type");
+        }
+    }
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+    bool show_time = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "t")) != -1)
+    {
+        switch (opt)
+        {
+            case 't':
+                show_time = true;
+                break;
+            default:
+                std::cerr << "usage: " << argv[0] << " [-t] <file>"
+                          << std::endl;
+                return 1;
+        }
+    }
+    if (optind + 1 != argc)
+    {
+        std::cerr << "usage: " << argv[0] << " [-t] <file>" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        std::ifstream ifs(argv[optind], std::ios::binary);
+        if (!ifs)
+        {
+            throw std::runtime_error(std::string("failed to open ") +
+                                     argv[optind]);
+        }
+        std::vector<char> buf((std::istreambuf_iterator<char>(ifs)),
+                              std::istreambuf_iterator<char>());
+        decode(buf, show_time);
+    }
+    catch (std::exception& e)
+    {
+        std::cout.flush();
+        std::cerr << "catch exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
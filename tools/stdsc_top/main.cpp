@@ -0,0 +1,172 @@
+/*
+ * Copyright 2018 Yamana Laboratory, Waseda University
+ * Supported by JST CREST Grant Number JPMJCR1503, Japan.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE‐2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <iostream>
+#include <map>
+#include <stdsc/stdsc_exception.hpp>
+#include <stdsc/stdsc_stats_segment.hpp>
+
+/*
+ * Shows the statistics of a running server, read from its shared memory
+ * segment (stdsc::Server::enable_stats_segment()).
+ *   usage: stdsc_top [-d delay_sec] [-n count] <port>
+ */
+
+namespace
+{
+
+volatile sig_atomic_t g_stop = 0;
+
+void on_signal(int)
+{
+    g_stop = 1;
+}
+
+double per_sec(const uint64_t cur, const uint64_t prev, const double sec)
+{
+    return (prev <= cur && 0 < sec) ? (cur - prev) / sec : 0.0;
+}
+
+void render(const char* port, const stdsc::StatsSegmentData& cur,
+            const stdsc::StatsSegmentData& prev)
+{
+    const double sec = (prev.elapsed_ns < cur.elapsed_ns)
+                         ? (cur.elapsed_ns - prev.elapsed_ns) / 1e9
+                         : 0.0;
+    std::map<uint64_t, const stdsc::StatsSegmentCode*> prev_codes;
+    for (uint64_t i = 0; i < prev.num_codes; ++i)
+    {
+        prev_codes[prev.codes[i].code] = &prev.codes[i];
+    }
+
+    /* busy time of the connection threads over the interval */
+    uint64_t busy = 0;
+    uint64_t prev_busy = 0;
+    for (uint64_t i = 0; i < cur.num_codes; ++i)
+    {
+        busy += cur.codes[i].busy_ns;
+    }
+    for (uint64_t i = 0; i < prev.num_codes; ++i)
+    {
+        prev_busy += prev.codes[i].busy_ns;
+    }
+    const double threads = per_sec(busy, prev_busy, sec) / 1e9;
+    const double utilization =
+      (0 < cur.active_connections) ? threads / cur.active_connections : 0.0;
+
+    printf("\033[H\033[2J");
+    printf("stdsc_top - port %s, pid %llu, up %.0f s\n", port,
+           static_cast<unsigned long long>(cur.pid), cur.elapsed_ns / 1e9);
+    printf("connections: %llu active, %llu total, %.1f/s   "
+           "threads busy: %.2f (%.1f%%)\n\n",
+           static_cast<unsigned long long>(cur.active_connections),
+           static_cast<unsigned long long>(cur.connections),
+           per_sec(cur.connections, prev.connections, sec), threads,
+           utilization * 100);
+    printf("%-10s %10s %8s %12s %12s %10s %10s %10s\n", "CODE", "REQ/s",
+           "REJ/s", "RECV B/s", "SEND B/s", "CB us", "CB p50", "CB p99");
+
+    for (uint64_t i = 0; i < cur.num_codes; ++i)
+    {
+        const auto& c = cur.codes[i];
+        stdsc::StatsSegmentCode zero = stdsc::StatsSegmentCode();
+        auto it = prev_codes.find(c.code);
+        const auto& p = (it != prev_codes.end()) ? *it->second : zero;
+        const uint64_t requests = (p.requests <= c.requests)
+                                    ? c.requests - p.requests
+                                    : 0;
+        const double callback_us =
+          (0 < requests) ? (c.callback_ns - p.callback_ns) / 1e3 / requests
+                         : 0.0;
+        printf("0x%08llx %10.1f %8.1f %12.0f %12.0f %10.1f %10.1f %10.1f\n",
+               static_cast<unsigned long long>(c.code),
+               per_sec(c.requests, p.requests, sec),
+               per_sec(c.rejects, p.rejects, sec),
+               per_sec(c.bytes_received, p.bytes_received, sec),
+               per_sec(c.bytes_sent, p.bytes_sent, sec), callback_us,
+               c.callback_p50_ns / 1e3, c.callback_p99_ns / 1e3);
+    }
+    printf("\n(rates over the last %.1f s; percentiles since start)\n", sec);
+    fflush(stdout);
+}
+
+void usage(const char* cmd)
+{
+    std::cerr << "usage: " << cmd << " [-d delay_sec] [-n count] <port>"
+              << std::endl;
+}
+
+} /* namespace */
+
+int main(int argc, char* argv[])
+{
+    double delay = 1.0;
+    long count = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+                delay = atof(optarg);
+                break;
+            case 'n':
+                count = atol(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind + 1 != argc || delay <= 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    const char* port = argv[optind];
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    try
+    {
+        stdsc::StatsSegmentReader reader(port);
+        stdsc::StatsSegmentData prev, cur;
+        reader.read(prev);
+        while (!g_stop && count != 0)
+        {
+            usleep(static_cast<useconds_t>(delay * 1e6));
+            reader.read(cur);
+            render(port, cur, prev);
+            prev = cur;
+            if (0 < count)
+            {
+                --count;
+            }
+        }
+    }
+    catch (stdsc::AbstractException& e)
+    {
+        std::cerr << "catch exception: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}